@@ -35,10 +35,16 @@
 #include <rte_bus_pci.h>
 #include <rte_branch_prediction.h>
 #include <rte_memory.h>
+#include <rte_memzone.h>
 #include <rte_kvargs.h>
 #include <rte_eal.h>
 #include <rte_alarm.h>
 #include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_net.h>
+#include <rte_errno.h>
 #include <rte_ethdev_driver.h>
 #include <rte_ethdev_pci.h>
 #include <rte_malloc.h>
@@ -47,6 +53,8 @@
 #include <rte_dev.h>
 #include <rte_flow.h>
 #include <rte_time.h>
+#include <rte_cpuflags.h>
+#include <rte_vect.h>
 
 
 #define MQNIC_INTEL_VENDOR_ID 0x1234
@@ -81,6 +89,18 @@
 	ETH_RSS_IPV6_TCP_EX | \
 	ETH_RSS_IPV6_UDP_EX)
 
+/*
+ * Flow types hashed by the RX hash unit of the interface: IPv4, and TCP
+ * and UDP over IPv4.
+ */
+#define MQNIC_RSS_OFFLOAD_ALL ( \
+	ETH_RSS_IPV4 | \
+	ETH_RSS_NONFRAG_IPV4_TCP | \
+	ETH_RSS_NONFRAG_IPV4_UDP)
+
+/* Size of the redirection table reported to and accepted from the ethdev layer. */
+#define MQNIC_RSS_RETA_SIZE ETH_RSS_RETA_SIZE_512
+
 /*
  * The overhead from MTU to max frame size.
  * Considering VLAN so a tag needs to be counted.
@@ -96,7 +116,99 @@
  * (num_ring_desc * sizeof(struct mqnic_rx/tx_desc)) % 128 == 0
  */
 #define	MQNIC_MIN_RING_DESC	32
-#define	MQNIC_MAX_RING_DESC	1024
+/*
+ * The queue managers keep 16-bit head and tail pointers, so a ring can
+ * have up to 2^15 entries and still tell a full ring from an empty one.
+ */
+#define	MQNIC_MAX_RING_DESC	32768
+
+/*
+ * TX completions are only reclaimed once fewer than this many ring slots
+ * are free, so the CQ head pointer read and tail pointer write are paid
+ * once per batch rather than once per burst. Rings too small for it use
+ * half of their fillable slots instead.
+ */
+#define	MQNIC_DEFAULT_TX_FREE_THRESH	32
+
+/*
+ * Share of a TX ring that may hold packets not yet completed, in percent,
+ * unless the tx_fill_pct devarg says otherwise.
+ */
+#define	MQNIC_DEFAULT_TX_FILL_PCT	50
+#define	MQNIC_MIN_TX_FILL_PCT		1
+#define	MQNIC_MAX_TX_FILL_PCT		100
+
+/*
+ * Fewest fillable slots of a TX ring, however small tx_fill_pct, so that
+ * the default tx_free_thresh of 1 stays below the fill limit.
+ */
+#define	MQNIC_MIN_TX_FULL_SIZE		2
+
+#define	MQNIC_DEVARG_TX_FILL_PCT	"tx_fill_pct"
+
+/*
+ * Completion rings default to the size of the ring they serve and event
+ * rings to the number of completion rings mapped to them, at least
+ * MQNIC_MIN_EQ_SIZE. The devargs below override either.
+ */
+#define	MQNIC_MIN_EQ_SIZE		32
+
+#define	MQNIC_DEVARG_TX_CQ_SIZE		"tx_cq_size"
+#define	MQNIC_DEVARG_RX_CQ_SIZE		"rx_cq_size"
+#define	MQNIC_DEVARG_EQ_SIZE		"eq_size"
+
+/*
+ * Keep completion rings armed so that rte_pmd_mqnic_poll_events() sees
+ * every queue with pending completions.
+ */
+#define	MQNIC_DEVARG_EVENT_POLL		"event_poll"
+
+/*
+ * Without RX interrupts or event_poll no completion or event ring is ever
+ * armed, and the completion ring tail pointer only has to be written back
+ * before the hardware could find the ring full. It is then written once
+ * per this many consumed completions, as far as the room of the completion
+ * ring beyond what its queue can have outstanding allows; completion rings
+ * sized by default get that room. The cq_tail_batch devarg overrides it.
+ */
+#define	MQNIC_DEFAULT_CQ_TAIL_BATCH	64
+
+#define	MQNIC_DEVARG_CQ_TAIL_BATCH	"cq_tail_batch"
+
+/*
+ * Consecutive RX polls finding no completion in host memory after which
+ * the completion ring head pointer register is read instead.
+ */
+#define	MQNIC_RX_CQ_HEAD_READ_INTERVAL	64
+
+/* Transmitted mbufs returned to their mempool per bulk call. */
+#define	MQNIC_TX_FREE_BULK	64
+
+/*
+ * RX buffers are only refilled once at least this many ring slots are
+ * empty, so mbufs are taken from the mempool in bulk and the head pointer
+ * doorbell is written once per batch. Rings too small for it use half of
+ * their slots instead.
+ */
+#define	MQNIC_DEFAULT_RX_FREE_THRESH	32
+
+/*
+ * After a failed refill the next attempts are skipped for a number of
+ * polls that doubles on every further failure, up to this limit.
+ */
+#define	MQNIC_RX_REFILL_BACKOFF_MAX	64
+
+/*
+ * Hardware counters of the stats block exported as xstats, and the
+ * minimum time between two snapshots of them. Counters narrower than 64
+ * bits are widened in software, which only needs a snapshot more often
+ * than they wrap.
+ */
+#define	MQNIC_HW_XSTATS_MAX	32
+#define	MQNIC_HW_STATS_INTERVAL_MS	10
+
+/* Queue not mapped to any of the per-queue counters of rte_eth_stats. */
+#define	MQNIC_QUEUE_STATS_UNMAPPED	0xff
 
 /*
  * TDBA/RDBA should be aligned on 16 byte boundary. But TDLEN/RDLEN should be
@@ -106,6 +218,14 @@
  */
 #define	MQNIC_ALIGN	128
 
+/*
+ * Ring memory zone types, see mqnic_ring_mem_reserve(). A queue's zone
+ * carries its descriptor ring followed by its completion ring.
+ */
+#define	MQNIC_RING_MEM_TX	"txq"
+#define	MQNIC_RING_MEM_RX	"rxq"
+#define	MQNIC_RING_MEM_EQ	"eq"
+
 //#define	IGB_RXD_ALIGN	(MQNIC_ALIGN / sizeof(union mqnic_adv_rx_desc))
 //#define	IGB_TXD_ALIGN	(MQNIC_ALIGN / sizeof(union mqnic_adv_tx_desc))
 
@@ -143,9 +263,6 @@
 #define MQNIC_ERR_INVM_VALUE_NOT_FOUND	20
 
 
-extern uint32_t event_queue_size;   //number of event queue
-extern uint32_t cpl_queue_size;   //number of event queue
-
 
 #ifndef ETH_ALEN
 #define ETH_ALEN 6
@@ -313,6 +430,13 @@ struct mqnic_hw {
 	u32 if_count;
 	u32 if_stride;
 	u32 if_csr_offset;
+
+	struct mqnic_reg_block *stats_rb;
+
+	u32 stats_offset;
+	u32 stats_count;
+	u32 stats_stride;
+	u32 stats_flags;
 };
 
 struct mqnic_if {
@@ -341,27 +465,28 @@ struct mqnic_if {
 	u32 event_queue_offset;
 	u32 event_queue_count;
 	u32 event_queue_stride;
-	struct mqnic_eq_ring *event_ring[MQNIC_MAX_EVENT_RINGS];
+	struct mqnic_eq_ring **event_ring;
 
 	u32 tx_queue_offset;
 	u32 tx_queue_count; /*Queue count is controled by dpdk apps*/
 	u32 tx_queue_stride;
-	struct mqnic_ring *tx_ring[MQNIC_MAX_TX_RINGS];
 
 	u32 tx_cpl_queue_offset;
 	u32 tx_cpl_queue_count;
 	u32 tx_cpl_queue_stride;
-	struct mqnic_cq_ring *tx_cpl_ring[MQNIC_MAX_TX_CPL_RINGS];
+	struct mqnic_cq_ring **tx_cpl_ring;
 
 	u32 rx_queue_offset;
 	u32 rx_queue_count; /*Queue count is controled by dpdk apps*/
 	u32 rx_queue_stride;
-	struct mqnic_ring *rx_ring[MQNIC_MAX_RX_RINGS];
 
 	u32 rx_cpl_queue_offset;
 	u32 rx_cpl_queue_count;
 	u32 rx_cpl_queue_stride;
-	struct mqnic_cq_ring *rx_cpl_ring[MQNIC_MAX_RX_CPL_RINGS];
+	struct mqnic_cq_ring **rx_cpl_ring;
+
+	const struct rte_memzone **tx_ring_mem; // ring memory per TX queue
+	const struct rte_memzone **rx_ring_mem; // ring memory per RX queue
 
 	u32 port_count;
 	struct mqnic_port *port[MQNIC_MAX_PORTS];
@@ -441,21 +566,36 @@ struct mqnic_adapter {
 	bool port_up;
 
 	u32 if_features;
-
+	u32 tx_fill_pct;   /**< Fillable share of each TX ring, in percent. */
+	u32 tx_cq_size;    /**< TX completion ring size, 0 to follow the TX ring. */
+	u32 rx_cq_size;    /**< RX completion ring size, 0 to follow the RX ring. */
+	u32 eq_size;       /**< Event ring size, 0 for the default. */
+	u32 event_poll;    /**< Queues are found through rte_pmd_mqnic_poll_events(). */
+	u32 cq_tail_batch; /**< Completions per CQ tail pointer write, unarmed CQs. */
+
+	uint64_t rss_hf;   /**< Hashed RSS flow types, 0 or MQNIC_RSS_OFFLOAD_ALL. */
+	u32 rss_offset;    /**< First RX queue of the RSS range. */
+	u32 rss_mask;      /**< RSS hash mask, size of the RSS range minus one. */
+
+	/*
+	 * Ring tables are shared with the interface and sized from the
+	 * queue counts reported by the queue managers.
+	 */
 	u32 event_queue_count;
-	struct mqnic_eq_ring *event_ring[MQNIC_MAX_EVENT_RINGS];
+	struct mqnic_eq_ring **event_ring;
 
 	u32 tx_queue_count;
-	struct mqnic_ring *tx_ring[MQNIC_MAX_TX_RINGS];
 
 	u32 tx_cpl_queue_count;
-	struct mqnic_cq_ring *tx_cpl_ring[MQNIC_MAX_TX_CPL_RINGS];
+	struct mqnic_cq_ring **tx_cpl_ring;
 
 	u32 rx_queue_count;
-	struct mqnic_ring *rx_ring[MQNIC_MAX_RX_RINGS];
 
 	u32 rx_cpl_queue_count;
-	struct mqnic_cq_ring *rx_cpl_ring[MQNIC_MAX_RX_CPL_RINGS];
+	struct mqnic_cq_ring **rx_cpl_ring;
+
+	const struct rte_memzone **tx_ring_mem;
+	const struct rte_memzone **rx_ring_mem;
 
 	u32 sched_block_count;
 	struct mqnic_sched_block *sched_block[MQNIC_MAX_PORTS];
@@ -464,10 +604,17 @@ struct mqnic_adapter {
 
 	struct i2c_client *mod_i2c_client;
 
-	uint64_t ipackets;  /**< Total number of successfully received packets. */
-	uint64_t opackets;  /**< Total number of successfully transmitted packets.*/
-	uint64_t ibytes;    /**< Total number of successfully received bytes. */
-	uint64_t obytes;    /**< Total number of successfully transmitted bytes. */
+	/*
+	 * Snapshot of the hardware counters exported as xstats, widened to
+	 * 64 bits, see mqnic_hw_stats_update().
+	 */
+	uint64_t hw_stats[MQNIC_HW_XSTATS_MAX];
+	uint64_t hw_stats_raw[MQNIC_HW_XSTATS_MAX]; /**< last value read */
+	uint64_t hw_stats_tsc; /**< TSC of the last snapshot */
+
+	/* stats counter index of each queue, see eth_mqnic_queue_stats_mapping_set() */
+	uint8_t rx_queue_stats_map[RTE_MAX_QUEUES_PER_PORT];
+	uint8_t tx_queue_stats_map[RTE_MAX_QUEUES_PER_PORT];
 };
 
 struct mqnic_desc {
@@ -477,6 +624,15 @@ struct mqnic_desc {
 	u64 addr;
 };
 
+/*
+ * tx_csum_cmd of the first descriptor of a TX block: the NIC sums the
+ * frame from csum start to its end and stores the result csum offset
+ * bytes after csum start.
+ */
+#define MQNIC_TX_CSUM_CMD_ENABLE	0x8000
+#define MQNIC_TX_CSUM_CMD_OFFSET_SHIFT	8
+#define MQNIC_TX_CSUM_START_MAX		0xff
+
 struct mqnic_cpl {
 	u16 queue;
 	u16 index;
@@ -553,6 +709,10 @@ struct mqnic_ring {
 struct mqnic_cq_ring {
 	uint32_t head_ptr;
 	uint32_t tail_ptr;
+	uint32_t written_tail_ptr; // tail pointer last written to hardware
+	uint32_t tail_batch;      // completions consumed per tail pointer write
+	uint32_t clear_ptr;       // completions before it are invalidated
+	uint32_t empty_polls;     // host memory polls without a new completion
 
 	uint32_t size;
 	uint32_t size_mask;
@@ -590,10 +750,12 @@ struct mqnic_eq_ring {
 	size_t buf_size;
 	u8 *buf;
 	uint64_t buf_dma_addr;
+	const struct rte_memzone *mem;
 
 	int index;
 	int irq;
 	int active;
+	u32 cq_count; // completion queues mapped to this ring
 	void (*handler) (struct mqnic_eq_ring *);
 
 	struct mqnic_if *interface;
@@ -637,8 +799,6 @@ struct mqnic_rx_entry {
  */
 struct mqnic_tx_entry {
 	struct rte_mbuf *mbuf[4]; /**< mbuf associated with TX desc, if any. */
-	uint16_t next_id; /**< Index of next descriptor in ring. */
-	uint16_t last_id; /**< Index of last scattered descriptor. */
 };
 
 /**
@@ -646,8 +806,22 @@ struct mqnic_tx_entry {
  */
 enum mqnic_rxq_flags {
 	IGB_RXQ_FLAG_LB_BSWAP_VLAN = 0x01,
+	MQNIC_RXQ_FLAG_RX_HASH = 0x02, /**< deliver cpl->rx_hash in hash.rss */
+	MQNIC_RXQ_FLAG_RX_CSUM = 0x04, /**< derive checksum status from cpl->rx_csum */
+	MQNIC_RXQ_FLAG_ARM_CQ  = 0x08, /**< re-arm the CQ after each burst */
 };
 
+/**
+ * Software counters of one queue. They sit on a cache line of their own so
+ * that the burst functions of different lcores never share one, and are
+ * summed up by eth_mqnic_stats_get().
+ */
+struct mqnic_queue_stats {
+	uint64_t packets;   /**< packets received or transmitted. */
+	uint64_t bytes;     /**< bytes received or transmitted. */
+	uint64_t errors;    /**< packets dropped by the queue. */
+} __rte_cache_aligned;
+
 /**
  * Structure associated with each RX queue.
  */
@@ -665,6 +839,8 @@ struct mqnic_rx_queue {
 	uint16_t            rx_tail;    /**< current value of RDT register. */
 	uint16_t            nb_rx_hold; /**< number of held free RX desc. */
 	uint16_t            rx_free_thresh; /**< max free RX desc to hold. */
+	uint16_t            refill_backoff; /**< polls skipped after the last failed refill. */
+	uint16_t            refill_skip; /**< polls left before the next refill attempt. */
 	uint16_t            queue_id;   /**< RX queue index. */
 	uint16_t            reg_idx;    /**< RX queue register index. */
 	uint16_t            port_id;    /**< Device port identifier. */
@@ -675,13 +851,11 @@ struct mqnic_rx_queue {
 	uint8_t             drop_en;  /**< If not 0, set SRRCTL.Drop_En. */
 	uint32_t            flags;      /**< RX flags. */
 	uint64_t	    offloads;   /**< offloads of DEV_RX_OFFLOAD_* */
+	uint64_t	    mbuf_initializer; /**< value to init mbufs */
 
 	// corundum
 	// written on enqueue (i.e. start_xmit)
 	u32 head_ptr;
-	u64 bytes;
-	u64 packets;
-	u64 dropped_packets;
 	//struct netdev_queue *tx_queue;
 
 	// written from completion
@@ -701,6 +875,7 @@ struct mqnic_rx_queue {
 
 	u32 mtu;
 	u32 page_order;
+	u32 rx_buf_len; // bytes posted per descriptor
 
 	u32 desc_block_size;
 	u32 log_desc_block_size;
@@ -718,6 +893,8 @@ struct mqnic_rx_queue {
 
 	struct mqnic_adapter *adapter;
 	struct mqnic_hw *hw;
+
+	struct mqnic_queue_stats stats; /**< written by the polling lcore only */
 };
 
 /**
@@ -734,6 +911,8 @@ struct mqnic_tx_queue {
 	uint16_t               tx_tail; /**< Current value of TDT register. */
 	uint16_t               tx_head;
 	/**< Index of first used TX descriptor. */
+	uint16_t               tx_free_thresh;
+	/**< Reclaim completions when fewer free slots remain. */
 	uint16_t               queue_id; /**< TX queue index. */
 	uint16_t               reg_idx;  /**< TX queue register index. */
 	uint16_t               port_id;  /**< Device port identifier. */
@@ -749,9 +928,6 @@ struct mqnic_tx_queue {
 	//mqnic
 	// written on enqueue (i.e. start_xmit)
 	uint32_t head_ptr;
-	uint64_t bytes;
-	uint64_t packets;
-	uint64_t dropped_packets;
 	struct netdev_queue *tx_queue;
 
 	// written from completion
@@ -767,6 +943,7 @@ struct mqnic_tx_queue {
 	uint32_t stride;
 
 	uint32_t cpl_index;
+	struct mqnic_cq_ring *cq_ring;
 
 	uint32_t mtu;
 	uint32_t page_order;
@@ -787,8 +964,125 @@ struct mqnic_tx_queue {
 
 	struct mqnic_adapter *adapter;
 	struct mqnic_hw *hw;
+
+	struct mqnic_queue_stats stats; /**< written by the polling lcore only */
 };
 
+static inline uint32_t
+mqnic_tx_free_slots(const struct mqnic_tx_queue *txq)
+{
+	return txq->full_size - (txq->head_ptr - txq->clean_tail_ptr);
+}
+
+/* Largest frame the RX queues must hold, as configured through ethdev. */
+static inline uint32_t
+mqnic_rx_max_frame_len(const struct rte_eth_dev *dev)
+{
+	const struct rte_eth_rxmode *rxmode = &dev->data->dev_conf.rxmode;
+
+	if (rxmode->offloads & DEV_RX_OFFLOAD_JUMBO_FRAME)
+		return rxmode->max_rx_pkt_len;
+	return dev->data->mtu + MQNIC_ETH_OVERHEAD;
+}
+
+static inline void
+mqnic_cq_read_head_ptr(struct mqnic_cq_ring *ring)
+{
+	ring->head_ptr += (MQNIC_DIRECT_READ_REG(ring->hw_head_ptr, 0) - ring->head_ptr) & ring->hw_ptr_mask;
+	PMD_TX_LOG(DEBUG, "get cq ring->head_ptr = %d", ring->head_ptr);
+}
+
+/*
+ * Find the RX completions written since the last poll in host memory
+ * instead of reading the head pointer register: consumed completions are
+ * invalidated by clearing their len, which the hardware never writes as
+ * zero for a received frame, so completions are valid up to the first
+ * cleared one. Up to max entries past the tail are inspected. The head
+ * pointer register is still read after MQNIC_RX_CQ_HEAD_READ_INTERVAL
+ * polls in a row found nothing, so a completion the scan cannot tell
+ * apart is not stuck for good.
+ */
+static inline void
+mqnic_rx_cq_poll_head_ptr(struct mqnic_cq_ring *ring, uint32_t max)
+{
+	volatile struct mqnic_cpl *cpl;
+	uint32_t head_ptr = ring->head_ptr;
+
+	while (head_ptr - ring->tail_ptr < max) {
+		cpl = (volatile struct mqnic_cpl *)(ring->buf +
+			(head_ptr & ring->size_mask) * ring->stride);
+		if (cpl->len == 0)
+			break;
+		head_ptr++;
+	}
+
+	if (head_ptr != ring->tail_ptr) {
+		ring->head_ptr = head_ptr;
+		ring->empty_polls = 0;
+		/* read the rest of the completions after their len */
+		rte_smp_rmb();
+	} else if (++ring->empty_polls >= MQNIC_RX_CQ_HEAD_READ_INTERVAL) {
+		ring->empty_polls = 0;
+		mqnic_cq_read_head_ptr(ring);
+	}
+}
+
+/*
+ * Clear the len of the completions consumed since the last call, before
+ * the tail pointer that hands their entries back to the hardware is
+ * written.
+ */
+static inline void
+mqnic_rx_cq_clear(struct mqnic_cq_ring *ring)
+{
+	volatile struct mqnic_cpl *cpl;
+
+	for (; ring->clear_ptr != ring->tail_ptr; ring->clear_ptr++) {
+		cpl = (volatile struct mqnic_cpl *)(ring->buf +
+			(ring->clear_ptr & ring->size_mask) * ring->stride);
+		cpl->len = 0;
+	}
+}
+
+static inline void
+mqnic_eq_read_head_ptr(struct mqnic_eq_ring *ring)
+{
+	ring->head_ptr += (MQNIC_DIRECT_READ_REG(ring->hw_head_ptr, 0) - ring->head_ptr) & ring->hw_ptr_mask;
+}
+
+static inline void
+mqnic_eq_write_tail_ptr(struct mqnic_eq_ring *ring)
+{
+	MQNIC_DIRECT_WRITE_REG(ring->hw_tail_ptr, 0, ring->tail_ptr & ring->hw_ptr_mask);
+}
+
+/*
+ * TX offloads that the vector TX paths cannot honour. A queue requesting
+ * any of them keeps the scalar eth_mqnic_xmit_pkts().
+ */
+#define MQNIC_TX_NO_VECTOR_FLAGS ( \
+	DEV_TX_OFFLOAD_MULTI_SEGS | \
+	DEV_TX_OFFLOAD_UDP_CKSUM | \
+	DEV_TX_OFFLOAD_TCP_CKSUM)
+
+/* mbuf TX offload flags handled by eth_mqnic_xmit_pkts(). */
+#define MQNIC_TX_OFFLOAD_MASK ( \
+	PKT_TX_IPV4 | \
+	PKT_TX_IPV6 | \
+	PKT_TX_L4_MASK)
+
+#define MQNIC_TX_OFFLOAD_NOTSUP_MASK \
+	(PKT_TX_OFFLOAD_MASK ^ MQNIC_TX_OFFLOAD_MASK)
+
+/*
+ * RX offloads that the vector RX path cannot honour. Scattered packets
+ * need the per-segment chaining of the scalar bursts, and checksum status
+ * needs a walk of the packet headers.
+ */
+#define MQNIC_RX_NO_VECTOR_FLAGS ( \
+	DEV_RX_OFFLOAD_SCATTER | \
+	DEV_RX_OFFLOAD_CHECKSUM)
+
 #if 1
 #define RTE_PMD_USE_PREFETCH
 #endif
@@ -850,6 +1144,23 @@ void mqnic_single_port_destroy(struct mqnic_port *port);
  * Completion queue manipulations
  */
 void mqnic_arm_cq(struct mqnic_cq_ring *ring);
+int mqnic_cpl_queue_setup(struct rte_eth_dev *dev, bool is_tx, uint32_t index,
+			  uint32_t size, u8 *buf, uint64_t buf_dma_addr, int socket_id);
+void mqnic_cpl_queue_free(struct rte_eth_dev *dev, bool is_tx, uint32_t index);
+
+static inline size_t
+mqnic_cpl_ring_bytes(uint32_t size)
+{
+	return (size_t)roundup_pow_of_two(size) * roundup_pow_of_two(MQNIC_CPL_SIZE);
+}
+
+/*
+ * Ring memory
+ */
+const struct rte_memzone *mqnic_ring_mem_reserve(struct rte_eth_dev *dev,
+		const struct rte_memzone **mem, const char *type, uint32_t index,
+		size_t size, int socket_id);
+void mqnic_ring_mem_free(const struct rte_memzone **mem);
 
 
 /*
@@ -898,11 +1209,18 @@ int eth_mqnic_rx_init(struct rte_eth_dev *dev);
 int eth_mqnic_tx_init(struct rte_eth_dev *dev);
 
 uint16_t eth_mqnic_xmit_pkts(void *txq, struct rte_mbuf **tx_pkts, uint16_t nb_pkts);
-//uint16_t eth_mqnic_prep_pkts(void *txq, struct rte_mbuf **tx_pkts,
-//		uint16_t nb_pkts);
+uint16_t eth_mqnic_xmit_pkts_vec_avx2(void *txq, struct rte_mbuf **tx_pkts, uint16_t nb_pkts);
+uint16_t eth_mqnic_xmit_pkts_vec_avx512(void *txq, struct rte_mbuf **tx_pkts, uint16_t nb_pkts);
+uint32_t mqnic_tx_reclaim(struct mqnic_tx_queue *txq);
+void mqnic_set_tx_function(struct rte_eth_dev *dev);
+uint16_t eth_mqnic_prep_pkts(void *txq, struct rte_mbuf **tx_pkts,
+		uint16_t nb_pkts);
 uint16_t eth_mqnic_recv_pkts(void *rxq, struct rte_mbuf **rx_pkts, uint16_t nb_pkts);
 uint16_t eth_mqnic_recv_scattered_pkts(void *rxq,
 		struct rte_mbuf **rx_pkts, uint16_t nb_pkts);
+uint16_t eth_mqnic_recv_pkts_vec_avx2(void *rxq, struct rte_mbuf **rx_pkts, uint16_t nb_pkts);
+void mqnic_rx_complete(struct mqnic_rx_queue *rxq, struct mqnic_cq_ring *cq_ring);
+void mqnic_set_rx_function(struct rte_eth_dev *dev);
 
 void mqnic_rxq_info_get(struct rte_eth_dev *dev, uint16_t queue_id, struct rte_eth_rxq_info *qinfo);
 void mqnic_txq_info_get(struct rte_eth_dev *dev, uint16_t queue_id, struct rte_eth_txq_info *qinfo);
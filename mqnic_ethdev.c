@@ -9,14 +9,11 @@
 #include "mqnic_osdep.h"
 #include "mqnic_regs.h"
 #include "rte_ethdev_core.h"
-
-uint32_t event_queue_size = 1024;   //number of event queue
-uint32_t cpl_queue_size = 1024;   //number of event queue
+#include "rte_pmd_mqnic.h"
 
 /*
  * Default values for port configuration
  */
-#define IGB_DEFAULT_RX_FREE_THRESH  32
 
 #define IGB_DEFAULT_RX_PTHRESH     8
 #define IGB_DEFAULT_RX_HTHRESH      8
@@ -45,10 +42,33 @@ static int  eth_mqnic_link_update(struct rte_eth_dev *dev,
 static int eth_mqnic_stats_get(struct rte_eth_dev *dev,
 				struct rte_eth_stats *rte_stats);
 static int eth_mqnic_stats_reset(struct rte_eth_dev *dev);
+static int eth_mqnic_queue_stats_mapping_set(struct rte_eth_dev *dev,
+					     uint16_t queue_id, uint8_t stat_idx,
+					     uint8_t is_rx);
+static void mqnic_init_queue_stats_map(struct mqnic_adapter *adapter);
+static int eth_mqnic_xstats_get(struct rte_eth_dev *dev,
+				struct rte_eth_xstat *xstats, unsigned int n);
+static int eth_mqnic_xstats_get_by_id(struct rte_eth_dev *dev,
+				const uint64_t *ids, uint64_t *values,
+				unsigned int n);
+static int eth_mqnic_xstats_get_names(struct rte_eth_dev *dev,
+				struct rte_eth_xstat_name *xstats_names,
+				unsigned int size);
+static void mqnic_hw_stats_update(struct rte_eth_dev *dev, bool force);
 static int eth_mqnic_infos_get(struct rte_eth_dev *dev,
 			      struct rte_eth_dev_info *dev_info);
 static const uint32_t *eth_mqnic_supported_ptypes_get(struct rte_eth_dev *dev);
 static int  eth_mqnic_mtu_set(struct rte_eth_dev *dev, uint16_t mtu);
+static int eth_mqnic_rss_reta_update(struct rte_eth_dev *dev,
+				struct rte_eth_rss_reta_entry64 *reta_conf,
+				uint16_t reta_size);
+static int eth_mqnic_rss_reta_query(struct rte_eth_dev *dev,
+				struct rte_eth_rss_reta_entry64 *reta_conf,
+				uint16_t reta_size);
+static int eth_mqnic_rx_queue_intr_enable(struct rte_eth_dev *dev,
+					  uint16_t queue_id);
+static int eth_mqnic_rx_queue_intr_disable(struct rte_eth_dev *dev,
+					   uint16_t queue_id);
 
 /*
  * Define VF Stats MACRO for Non "cleared on read" register
@@ -88,6 +108,42 @@ static const struct rte_eth_desc_lim tx_desc_lim = {
 	.nb_mtu_seg_max = IGB_TX_MAX_MTU_SEG,
 };
 
+/* store statistics names and its index in the hardware stats block */
+struct rte_mqnic_xstats_name_off {
+	char name[RTE_ETH_XSTATS_NAME_SIZE];
+	unsigned int index;
+};
+
+static const struct rte_mqnic_xstats_name_off rte_mqnic_hw_stats_strings[] = {
+	{"dma_rd_op_count", MQNIC_STATS_DMA_RD_OP_COUNT},
+	{"dma_rd_op_bytes", MQNIC_STATS_DMA_RD_OP_BYTES},
+	{"dma_rd_op_latency", MQNIC_STATS_DMA_RD_OP_LATENCY},
+	{"dma_rd_op_error", MQNIC_STATS_DMA_RD_OP_ERROR},
+	{"dma_rd_req_count", MQNIC_STATS_DMA_RD_REQ_COUNT},
+	{"dma_rd_req_latency", MQNIC_STATS_DMA_RD_REQ_LATENCY},
+	{"dma_rd_req_timeout", MQNIC_STATS_DMA_RD_REQ_TIMEOUT},
+	{"dma_rd_op_table_full", MQNIC_STATS_DMA_RD_OP_TABLE_FULL},
+	{"dma_rd_no_tags", MQNIC_STATS_DMA_RD_NO_TAGS},
+	{"dma_rd_tx_no_credit", MQNIC_STATS_DMA_RD_TX_NO_CREDIT},
+	{"dma_rd_tx_limit", MQNIC_STATS_DMA_RD_TX_LIMIT},
+	{"dma_rd_tx_stall", MQNIC_STATS_DMA_RD_TX_STALL},
+	{"dma_wr_op_count", MQNIC_STATS_DMA_WR_OP_COUNT},
+	{"dma_wr_op_bytes", MQNIC_STATS_DMA_WR_OP_BYTES},
+	{"dma_wr_op_latency", MQNIC_STATS_DMA_WR_OP_LATENCY},
+	{"dma_wr_op_error", MQNIC_STATS_DMA_WR_OP_ERROR},
+	{"dma_wr_req_count", MQNIC_STATS_DMA_WR_REQ_COUNT},
+	{"dma_wr_req_latency", MQNIC_STATS_DMA_WR_REQ_LATENCY},
+	{"dma_wr_req_timeout", MQNIC_STATS_DMA_WR_REQ_TIMEOUT},
+	{"dma_wr_op_table_full", MQNIC_STATS_DMA_WR_OP_TABLE_FULL},
+	{"dma_wr_no_tags", MQNIC_STATS_DMA_WR_NO_TAGS},
+	{"dma_wr_tx_no_credit", MQNIC_STATS_DMA_WR_TX_NO_CREDIT},
+	{"dma_wr_tx_limit", MQNIC_STATS_DMA_WR_TX_LIMIT},
+	{"dma_wr_tx_stall", MQNIC_STATS_DMA_WR_TX_STALL},
+};
+
+#define MQNIC_NB_HW_XSTATS (sizeof(rte_mqnic_hw_stats_strings) / \
+		sizeof(rte_mqnic_hw_stats_strings[0]))
+
 static const struct eth_dev_ops eth_mqnic_ops = {
 	.dev_configure        = eth_mqnic_configure,
 	.dev_start            = eth_mqnic_start,
@@ -99,16 +155,27 @@ static const struct eth_dev_ops eth_mqnic_ops = {
 	.link_update          = eth_mqnic_link_update,
 	.stats_get            = eth_mqnic_stats_get,
 	.stats_reset          = eth_mqnic_stats_reset,
+	.xstats_get           = eth_mqnic_xstats_get,
+	.xstats_get_by_id     = eth_mqnic_xstats_get_by_id,
+	.xstats_get_names     = eth_mqnic_xstats_get_names,
+	.xstats_reset         = eth_mqnic_stats_reset,
+	.queue_stats_mapping_set = eth_mqnic_queue_stats_mapping_set,
 	.dev_infos_get        = eth_mqnic_infos_get,
 	.dev_supported_ptypes_get = eth_mqnic_supported_ptypes_get,
 	.mtu_set              = eth_mqnic_mtu_set,
 	.rx_queue_setup       = eth_mqnic_rx_queue_setup,
 	.rx_queue_release     = eth_mqnic_rx_queue_release,
+	.rx_queue_intr_enable = eth_mqnic_rx_queue_intr_enable,
+	.rx_queue_intr_disable = eth_mqnic_rx_queue_intr_disable,
 	.tx_queue_setup       = eth_mqnic_tx_queue_setup,
 	.tx_queue_release     = eth_mqnic_tx_queue_release,
 	.tx_done_cleanup      = eth_mqnic_tx_done_cleanup,
 	.rxq_info_get         = mqnic_rxq_info_get,
 	.txq_info_get         = mqnic_txq_info_get,
+	.reta_update          = eth_mqnic_rss_reta_update,
+	.reta_query           = eth_mqnic_rss_reta_query,
+	.rss_hash_update      = eth_mqnic_rss_hash_update,
+	.rss_hash_conf_get    = eth_mqnic_rss_hash_conf_get,
 };
 
 static void mqnic_interface_set_rx_queue_map_offset(struct mqnic_if *interface, int port, u32 val)
@@ -141,6 +208,52 @@ static void mqnic_interface_set_rx_queue_map_app_mask(struct mqnic_if *interface
 			MQNIC_RB_RX_QUEUE_MAP_CH_STRIDE*port + MQNIC_RB_RX_QUEUE_MAP_CH_REG_APP_MASK, val);
 }
 
+/*
+ * Reserve size bytes of IOVA-contiguous ring memory of the given type and
+ * index into *mem. The zone already held in *mem is kept when it is large
+ * enough and on the requested socket, so reconfiguring a queue reuses its
+ * memory; otherwise it is freed and reserved anew.
+ */
+const struct rte_memzone *
+mqnic_ring_mem_reserve(struct rte_eth_dev *dev, const struct rte_memzone **mem,
+		       const char *type, uint32_t index, size_t size, int socket_id)
+{
+	char z_name[RTE_MEMZONE_NAMESIZE];
+	const struct rte_memzone *mz = *mem;
+
+	if (mz != NULL) {
+		if (mz->len >= size &&
+		    (socket_id == SOCKET_ID_ANY || mz->socket_id == socket_id))
+			return mz;
+		mqnic_ring_mem_free(mem);
+	}
+
+	snprintf(z_name, sizeof(z_name), "mqnic_%u_%s_%u",
+		 dev->data->port_id, type, index);
+	mz = rte_memzone_reserve_aligned(z_name, size, socket_id,
+					 RTE_MEMZONE_IOVA_CONTIG, MQNIC_ALIGN);
+	if (mz == NULL) {
+		PMD_INIT_LOG(ERR, "failed to reserve %zu bytes of %s ring memory %u",
+			     size, type, index);
+		return NULL;
+	}
+
+	PMD_INIT_LOG(DEBUG, "%s ring memory %u: addr=%p iova=0x%"PRIx64" len=%zu",
+		     type, index, mz->addr, mz->iova, mz->len);
+
+	*mem = mz;
+	return mz;
+}
+
+void
+mqnic_ring_mem_free(const struct rte_memzone **mem)
+{
+	if (*mem != NULL) {
+		rte_memzone_free(*mem);
+		*mem = NULL;
+	}
+}
+
 static void
 mqnic_event_queue_release(struct mqnic_eq_ring *ring)
 {
@@ -149,124 +262,133 @@ mqnic_event_queue_release(struct mqnic_eq_ring *ring)
 	}
 }
 
-static int
-mqnic_all_event_queue_create(struct mqnic_if *interface)
+/*
+ * A completion queue writes at most one event each time it is armed, so
+ * an event queue needs no more entries than the completion queues mapped
+ * to it, unless the eq_size devarg asks for more.
+ */
+static uint32_t
+mqnic_event_queue_size(struct mqnic_adapter *adapter)
+{
+	uint32_t nb_cq;
+
+	if (adapter->eq_size)
+		return adapter->eq_size;
+
+	nb_cq = adapter->tx_cpl_queue_count + adapter->rx_cpl_queue_count;
+	nb_cq = (nb_cq + adapter->event_queue_count - 1) / adapter->event_queue_count;
+	return RTE_MAX(nb_cq, (uint32_t)MQNIC_MIN_EQ_SIZE);
+}
+
+/*
+ * Take a reference on event ring index, creating it and reserving its
+ * memory next to the device on first use.
+ */
+static struct mqnic_eq_ring *
+mqnic_event_queue_get(struct rte_eth_dev *dev, uint32_t index)
 {
+	const struct rte_memzone *tz;
 	struct mqnic_eq_ring *ring;
-	uint32_t i;
-	
-	PMD_INIT_LOG(DEBUG, "mqnic_all_event_queue_create");
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	struct mqnic_if *interface = adapter->interface;
 
-	for (i = 0; i < interface->event_queue_count; i++){
-		/* Free memory prior to re-allocation if needed */
-		if (interface->event_ring[i] != NULL) {
-			PMD_INIT_LOG(DEBUG, "release event ring %d", i);
-			mqnic_event_queue_release(interface->event_ring[i]);
-			interface->event_ring[i] = NULL;
-		}
+	ring = adapter->event_ring[index];
+	if (ring != NULL) {
+		ring->cq_count++;
+		return ring;
+	}
 
-		// Create event queue
-		ring = rte_zmalloc("ethdev event queue", sizeof(struct mqnic_eq_ring),
-							RTE_CACHE_LINE_SIZE);
-		if (ring == NULL){
-			PMD_INIT_LOG(ERR, "failed to alloc event queue");
-			return -ENOMEM;
-		}
+	PMD_INIT_LOG(DEBUG, "create event ring %u", index);
 
-		ring->interface = interface;
-		ring->index = i;
-		ring->active = 0;
+	ring = rte_zmalloc_socket("ethdev event queue", sizeof(struct mqnic_eq_ring),
+				  RTE_CACHE_LINE_SIZE, dev->data->numa_node);
+	if (ring == NULL) {
+		PMD_INIT_LOG(ERR, "failed to alloc event queue");
+		return NULL;
+	}
 
-		ring->hw_addr = interface->hw_addr + interface->event_queue_offset
-			+ i * interface->event_queue_stride;
-		ring->hw_ptr_mask = 0xffff;
-		ring->hw_head_ptr = ring->hw_addr + MQNIC_EVENT_QUEUE_HEAD_PTR_REG;
-		ring->hw_tail_ptr = ring->hw_addr + MQNIC_EVENT_QUEUE_TAIL_PTR_REG;
+	ring->interface = interface;
+	ring->index = index;
+	ring->active = 0;
 
-		ring->head_ptr = 0;
-		ring->tail_ptr = 0;
+	ring->hw_addr = interface->hw_addr + interface->event_queue_offset
+		+ index * interface->event_queue_stride;
+	ring->hw_ptr_mask = 0xffff;
+	ring->hw_head_ptr = ring->hw_addr + MQNIC_EVENT_QUEUE_HEAD_PTR_REG;
+	ring->hw_tail_ptr = ring->hw_addr + MQNIC_EVENT_QUEUE_TAIL_PTR_REG;
 
-		PMD_INIT_LOG(DEBUG, "ring->hw_addr=%p", ring->hw_addr);
+	ring->head_ptr = 0;
+	ring->tail_ptr = 0;
 
-		// Deactivate queue
-		MQNIC_DIRECT_WRITE_REG(ring->hw_addr, MQNIC_EVENT_QUEUE_ACTIVE_LOG_SIZE_REG, 0);
+	ring->size = roundup_pow_of_two(mqnic_event_queue_size(adapter));
+	ring->size_mask = ring->size - 1;
+	ring->stride = roundup_pow_of_two(MQNIC_EVENT_SIZE);
 
-		interface->event_ring[i] = ring;
+	ring->buf_size = ring->size * ring->stride;
+	tz = mqnic_ring_mem_reserve(dev, &ring->mem, MQNIC_RING_MEM_EQ, index,
+			ring->buf_size, dev->data->numa_node);
+	if (tz == NULL) {
+		PMD_INIT_LOG(ERR, "failed to alloc event ring buffer, i = %u.", index);
+		mqnic_event_queue_release(ring);
+		return NULL;
 	}
+	ring->buf = (u8*)tz->addr;
+	ring->buf_dma_addr = tz->iova;
+	memset(ring->buf, 0, ring->buf_size);
 
-	MQNIC_WRITE_FLUSH(interface);
+	PMD_INIT_LOG(DEBUG, "ring->buf=%p ring->hw_addr=%p ring->buf_dma_addr=0x%"PRIx64,
+		     ring->buf, ring->hw_addr, ring->buf_dma_addr);
 
-	return 0;
+	// Deactivate queue
+	MQNIC_DIRECT_WRITE_REG(ring->hw_addr, MQNIC_EVENT_QUEUE_ACTIVE_LOG_SIZE_REG, 0);
+	MQNIC_WRITE_FLUSH(ring);
+
+	ring->cq_count = 1;
+	adapter->event_ring[index] = ring;
+
+	return ring;
 }
 
-static int
-mqnic_all_event_queue_alloc(struct rte_eth_dev *dev, int socket_id)
+static void
+mqnic_event_queue_free(struct rte_eth_dev *dev, struct mqnic_eq_ring *ring)
 {
-	const struct rte_memzone *tz;
-	struct mqnic_eq_ring *ring;
-	uint32_t i;
 	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
-	
-	PMD_INIT_LOG(DEBUG, "mqnic_all_event_queue_alloc");
-
-	for (i = 0; i < adapter->event_queue_count; i++){
-		/* Free memory prior to re-allocation if needed */
-		if (adapter->event_ring[i]->buf != NULL) {
-			return -EINVAL;
-		}
-
-		ring = adapter->event_ring[i];
 
-		// Allocate event queue
-		ring->size = roundup_pow_of_two(event_queue_size);
-		ring->size_mask = ring->size - 1;
-		ring->stride = roundup_pow_of_two(MQNIC_EVENT_SIZE);
-
-		ring->buf_size = ring->size * ring->stride;
-		tz = rte_eth_dma_zone_reserve(dev, "event_ring", i,
-				ring->buf_size, MQNIC_ALIGN, socket_id);
-		if (tz == NULL) {
-			PMD_INIT_LOG(ERR, "failed to alloc event ring buffer, i = %d.", i);
-			rte_free(ring);
-			return -ENOMEM;
-		}
-		ring->buf = (u8*)tz->addr;
-		ring->buf_dma_addr = tz->iova;
+	// deactivate queue
+	MQNIC_DIRECT_WRITE_REG(ring->hw_addr, MQNIC_EVENT_QUEUE_ACTIVE_LOG_SIZE_REG, ilog2(ring->size));
+	// disarm queue
+	MQNIC_DIRECT_WRITE_REG(ring->hw_addr, MQNIC_EVENT_QUEUE_INTERRUPT_INDEX_REG, ring->irq);
+	MQNIC_WRITE_FLUSH(ring);
 
-		PMD_INIT_LOG(DEBUG, "ring->buf=%p ring->hw_addr=%p ring->buf_dma_addr=0x%"PRIx64,
-		     ring->buf, ring->hw_addr, ring->buf_dma_addr);
-	}
+	PMD_INIT_LOG(DEBUG, "release event ring %d", ring->index);
+	adapter->event_ring[ring->index] = NULL;
+	mqnic_ring_mem_free(&ring->mem);
+	mqnic_event_queue_release(ring);
+}
 
-	return 0;
+/* Drop a reference on an event ring, freeing it with the last one. */
+static void
+mqnic_event_queue_put(struct rte_eth_dev *dev, struct mqnic_eq_ring *ring)
+{
+	if (--ring->cq_count == 0)
+		mqnic_event_queue_free(dev, ring);
 }
 
 static void
 mqnic_all_event_queue_destroy(struct rte_eth_dev *dev)
 {
-	struct mqnic_eq_ring *ring;
 	uint32_t i;
 	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
-	
+
 	PMD_INIT_LOG(DEBUG, "mqnic_all_event_queue_destroy");
 
-	for (i = 0; i < adapter->event_queue_count; i++){
-		/* Free memory prior to re-allocation if needed */
-		if (adapter->event_ring[i] != NULL) {
-			ring = adapter->event_ring[i];
-			// deactivate queue
-			MQNIC_DIRECT_WRITE_REG(ring->hw_addr, MQNIC_EVENT_QUEUE_ACTIVE_LOG_SIZE_REG, ilog2(ring->size));
-			// disarm queue
-			MQNIC_DIRECT_WRITE_REG(ring->hw_addr, MQNIC_EVENT_QUEUE_INTERRUPT_INDEX_REG, ring->index);
-			MQNIC_WRITE_FLUSH(ring);
-			PMD_INIT_LOG(DEBUG, "release event ring %d", i);
-			mqnic_event_queue_release(adapter->event_ring[i]);
-			adapter->event_ring[i] = NULL;
-		}
+	if (adapter->event_ring == NULL)
+		return;
 
-		rte_eth_dma_zone_free(dev, "event_ring", i);
+	for (i = 0; i < adapter->event_queue_count; i++) {
+		if (adapter->event_ring[i] != NULL)
+			mqnic_event_queue_free(dev, adapter->event_ring[i]);
 	}
-
-	return;
 }
 
 static void
@@ -288,6 +410,7 @@ mqnic_all_event_queue_deactivate(struct rte_eth_dev *dev)
 			// disarm queue
 			MQNIC_DIRECT_WRITE_REG(ring->hw_addr, MQNIC_EVENT_QUEUE_INTERRUPT_INDEX_REG, ring->irq);
 			MQNIC_WRITE_FLUSH(interface);
+			ring->active = 0;
 		}
 	}
 
@@ -305,19 +428,20 @@ mqnic_all_event_queue_active(struct rte_eth_dev *dev)
 {
 	struct mqnic_eq_ring *ring;
 	uint32_t i;
-	int int_index = 0; //only one interrupt
 	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	struct rte_intr_handle *intr_handle = &RTE_ETH_DEV_TO_PCI(dev)->intr_handle;
 	
 	PMD_INIT_LOG(DEBUG, "mqnic_all_event_queue_active");
 
 	for (i = 0; i < adapter->event_queue_count; i++){
 		ring = adapter->event_ring[i];
-		/* Free memory prior to re-allocation if needed */
-		if (ring == NULL) {
-			PMD_INIT_LOG(ERR, "invalid event ring buffer, i = %d.", i);
-			return -1;
-		}
-		ring->irq = int_index;
+		/* no completion ring is mapped to this event ring */
+		if (ring == NULL)
+			continue;
+		// RX queue i owns event queue i in interrupt mode
+		ring->irq = 0;
+		if (intr_handle->intr_vec != NULL && i < dev->data->nb_rx_queues)
+			ring->irq = intr_handle->intr_vec[i];
 		ring->active = 1;
 
 		// deactivate queue
@@ -336,7 +460,9 @@ mqnic_all_event_queue_active(struct rte_eth_dev *dev)
 
 		MQNIC_WRITE_FLUSH(ring);
 
-		mqnic_arm_eq(ring);
+		// events are only needed as interrupts in RX interrupt mode
+		if (dev->data->dev_conf.intr_conf.rxq)
+			mqnic_arm_eq(ring);
 	}
 
 	return 0;
@@ -375,31 +501,6 @@ static void _create_cpl_queue(struct mqnic_cq_ring *ring, struct mqnic_if *inter
 	PMD_INIT_LOG(DEBUG, "ring->hw_addr=%p", ring->hw_addr);
 }
 
-static int _alloc_cpl_queue(struct mqnic_cq_ring *ring, struct rte_eth_dev *dev, int i, int socket_id) {
-	const struct rte_memzone *tz;
-	ring->size = roundup_pow_of_two(cpl_queue_size);
-	ring->size_mask = ring->size - 1;
-	ring->stride = roundup_pow_of_two(MQNIC_CPL_SIZE);
-
-	ring->buf_size = ring->size * ring->stride;
-	tz = rte_eth_dma_zone_reserve(dev, "cq_ring", i, ring->buf_size,
-			      MQNIC_ALIGN, socket_id);
-	if (tz == NULL) {
-		PMD_INIT_LOG(ERR, "failed to alloc cq ring buffer, i = %d, buf_size = 0x%lx, size = 0x%x, stride = 0x%x", i, ring->buf_size, ring->size, ring->stride);
-		rte_free(ring);
-		return -ENOMEM;
-	}
-
-	ring->buf = (u8*)tz->addr;
-	ring->buf_dma_addr = tz->iova;
-
-	PMD_INIT_LOG(DEBUG, "ring->buf=%p ring->hw_addr=%p ring->buf_dma_addr=0x%"PRIx64,
-	     ring->buf, ring->hw_addr, ring->buf_dma_addr);
-
-	return 0;
-}
-
-
 void mqnic_arm_cq(struct mqnic_cq_ring *ring)
 {
 	MQNIC_DIRECT_WRITE_REG(ring->hw_addr, MQNIC_CPL_QUEUE_INTERRUPT_INDEX_REG, ring->eq_index | MQNIC_CPL_QUEUE_ARM_MASK);
@@ -424,6 +525,23 @@ static void mqnic_active_cpl_queue_registers(struct mqnic_cq_ring *ring)
 	ring->active = 1;
 }
 
+/*
+ * Empty a completion ring and clear its memory. Completions written for an
+ * earlier setup or run of the queue name slots of a ring that has since
+ * been reset; neither the RX bursts nor the TX reclaim may take them for
+ * new ones.
+ */
+static void
+mqnic_cpl_queue_reset(struct mqnic_cq_ring *ring)
+{
+	ring->head_ptr = 0;
+	ring->tail_ptr = 0;
+	ring->written_tail_ptr = 0;
+	ring->clear_ptr = 0;
+	ring->empty_polls = 0;
+	memset(ring->buf, 0, ring->buf_size);
+}
+
 static void
 mqnic_tx_cpl_queue_active(struct rte_eth_dev *dev)
 {
@@ -433,23 +551,24 @@ mqnic_tx_cpl_queue_active(struct rte_eth_dev *dev)
 
 	PMD_INIT_LOG(DEBUG, "mqnic_tx_cpl_queue_active");
 
-	for (i = 0; i < adapter->tx_cpl_queue_count; i++){
+	for (i = 0; i < dev->data->nb_tx_queues; i++){
 		ring = adapter->tx_cpl_ring[i];
-		if (ring == NULL) {
-			PMD_INIT_LOG(ERR, "invalid tx cpl ring buffer, i = %d.", i);
-			return;
-		}
-
-		ring->eq_ring = adapter->event_ring[i % adapter->event_queue_count];
-		ring->eq_index = ring->eq_ring->index;
+		/* no queue has been set up on this completion ring */
+		if (ring == NULL || ring->buf == NULL)
+			continue;
 
 		PMD_INIT_LOG(DEBUG, "completion queue %d with event queue %d", i, ring->eq_index);
 
+		// the TX queue was reset on stop, a partial tx_done_cleanup may
+		// have left completions behind
+		mqnic_cpl_queue_reset(ring);
 		mqnic_active_cpl_queue_registers(ring);
-		mqnic_arm_cq(ring);
+		// only rte_pmd_mqnic_poll_events() wants TX completion events
+		if (adapter->event_poll)
+			mqnic_arm_cq(ring);
 	}
 
-	MQNIC_WRITE_FLUSH(ring);
+	MQNIC_WRITE_FLUSH(adapter->interface);
 	return;
 }
 
@@ -462,22 +581,23 @@ mqnic_rx_cpl_queue_active(struct rte_eth_dev *dev)
 
 	PMD_INIT_LOG(DEBUG, "mqnic_rx_cpl_queue_active");
 
-	for (i = 0; i < adapter->rx_cpl_queue_count; i++){
+	for (i = 0; i < dev->data->nb_rx_queues; i++){
 		ring = adapter->rx_cpl_ring[i];
-		if (ring == NULL) {
-			PMD_INIT_LOG(ERR, "invalid rx cpl ring buffer, i = %d.", i);
-			return;
-		}
-
-		ring->eq_ring = adapter->event_ring[i % adapter->event_queue_count];
-		ring->eq_index = ring->eq_ring->index;
+		/* no queue has been set up on this completion ring */
+		if (ring == NULL || ring->buf == NULL)
+			continue;
 		PMD_INIT_LOG(DEBUG, "completion queue %d with event queue %d", i, ring->eq_index);
 
+		// the RX queue was reset on stop, so are its completions
+		mqnic_cpl_queue_reset(ring);
 		mqnic_active_cpl_queue_registers(ring);
-		mqnic_arm_cq(ring);
+		// armed by rx_queue_intr_enable in interrupt mode, never when
+		// queues are only polled
+		if (adapter->event_poll)
+			mqnic_arm_cq(ring);
 	}
 
-	MQNIC_WRITE_FLUSH(ring);
+	MQNIC_WRITE_FLUSH(adapter->interface);
 	return;
 }
 
@@ -499,99 +619,99 @@ mqnic_init_cpl_queue_registers(struct mqnic_cq_ring *ring)
 	MQNIC_DIRECT_WRITE_REG(ring->hw_addr, MQNIC_CPL_QUEUE_ACTIVE_LOG_SIZE_REG, ilog2(ring->size));
 }
 
-static int
-mqnic_tx_cpl_queue_create(struct mqnic_if *interface)
+/*
+ * Set up the completion ring index of one direction with size entries at
+ * buf, carved by the caller from the ring memory of the queue it serves.
+ * The ring and its event ring are created on first use. Only called while
+ * the port is stopped, from queue setup.
+ */
+int
+mqnic_cpl_queue_setup(struct rte_eth_dev *dev, bool is_tx, uint32_t index,
+		      uint32_t size, u8 *buf, uint64_t buf_dma_addr, int socket_id)
 {
-	struct mqnic_cq_ring *ring;
-	uint32_t i;
-	
-	PMD_INIT_LOG(DEBUG, "mqnic_tx_cpl_queue_create");
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	struct mqnic_cq_ring **table = is_tx ? adapter->tx_cpl_ring : adapter->rx_cpl_ring;
+	struct mqnic_cq_ring *ring = table[index];
 
-	for (i = 0; i < interface->tx_cpl_queue_count; i++){
-		// Release existing buffers if have
-		if (interface->tx_cpl_ring[i] != NULL) {
-			PMD_INIT_LOG(DEBUG, "release tx cpl ring %d", i);
-			mqnic_cpl_queue_release(interface->tx_cpl_ring[i]);
-			interface->tx_cpl_ring[i] = NULL;
+	if (ring == NULL) {
+		ring = rte_zmalloc_socket(is_tx ? "ethdev tx cpl queue" : "ethdev rx cpl queue",
+					  sizeof(struct mqnic_cq_ring), RTE_CACHE_LINE_SIZE,
+					  socket_id);
+		if (ring == NULL) {
+			PMD_INIT_LOG(ERR, "failed to alloc %s cpl queue", is_tx ? "tx" : "rx");
+			return -ENOMEM;
 		}
 
-		/* allocate the completion queue data structure */
-		ring = rte_zmalloc("ethdev tx cpl queue", sizeof(struct mqnic_cq_ring),
-							RTE_CACHE_LINE_SIZE);
-		if (ring == NULL){
-			PMD_INIT_LOG(ERR, "failed to alloc tx cpl queue");
+		_create_cpl_queue(ring, adapter->interface, index, is_tx);
+
+		ring->eq_ring = mqnic_event_queue_get(dev, index % adapter->event_queue_count);
+		if (ring->eq_ring == NULL) {
+			mqnic_cpl_queue_release(ring);
 			return -ENOMEM;
 		}
+		ring->eq_index = ring->eq_ring->index;
 
-		// Create completion queue
-		_create_cpl_queue(ring, interface, i, true);
-
-		interface->tx_cpl_ring[i] = ring;
+		table[index] = ring;
 	}
 
-	MQNIC_WRITE_FLUSH(interface);
-	return 0;
-}
+	MQNIC_DIRECT_WRITE_REG(ring->hw_addr, MQNIC_CPL_QUEUE_ACTIVE_LOG_SIZE_REG, 0);
+	ring->tail_batch = 1;
 
+	ring->size = roundup_pow_of_two(size);
+	ring->size_mask = ring->size - 1;
+	ring->stride = roundup_pow_of_two(MQNIC_CPL_SIZE);
+	ring->buf_size = mqnic_cpl_ring_bytes(size);
 
-static int
-mqnic_tx_cpl_queue_alloc(struct rte_eth_dev *dev, int socket_id)
-{
-	struct mqnic_cq_ring *ring;
-	uint32_t i;
-	int ret;
-	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
-	
-	PMD_INIT_LOG(DEBUG, "mqnic_tx_cpl_queue_create");
+	// reused memory may still hold completions of the previous setup
+	ring->buf = buf;
+	ring->buf_dma_addr = buf_dma_addr;
+	mqnic_cpl_queue_reset(ring);
 
-	for (i = 0; i < adapter->tx_cpl_queue_count; i++){
-		// Release existing buffers if have
-		if (adapter->tx_cpl_ring[i]->buf != NULL) {
-			return -EINVAL;
-		}
+	PMD_INIT_LOG(DEBUG, "%s cpl queue %u: %u entries ring->buf=%p ring->buf_dma_addr=0x%"PRIx64,
+		     is_tx ? "tx" : "rx", ring->index, ring->size, ring->buf, ring->buf_dma_addr);
 
-		ring = adapter->tx_cpl_ring[i];
+	mqnic_init_cpl_queue_registers(ring);
+	return 0;
+}
 
-		// Allocate completion queue buffer
-		if ((ret = _alloc_cpl_queue(ring, dev, i, socket_id)))
-			return ret;
+/*
+ * Free the completion ring index of one direction and drop its reference
+ * on the event ring. Called on queue release; the ring memory stays with
+ * the queue index for the next setup.
+ */
+void
+mqnic_cpl_queue_free(struct rte_eth_dev *dev, bool is_tx, uint32_t index)
+{
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	struct mqnic_cq_ring **table = is_tx ? adapter->tx_cpl_ring : adapter->rx_cpl_ring;
+	struct mqnic_cq_ring *ring;
 
-		// Write settings into hardware
-		mqnic_init_cpl_queue_registers(ring);
-	}
+	if (table == NULL || table[index] == NULL)
+		return;
 
+	ring = table[index];
+	// deactivate queue
+	MQNIC_DIRECT_WRITE_REG(ring->hw_addr, MQNIC_CPL_QUEUE_ACTIVE_LOG_SIZE_REG, 0);
+	// disarm queue
+	MQNIC_DIRECT_WRITE_REG(ring->hw_addr, MQNIC_CPL_QUEUE_INTERRUPT_INDEX_REG, ring->eq_index);
 	MQNIC_WRITE_FLUSH(ring);
-	return 0;
+
+	PMD_INIT_LOG(DEBUG, "release %s cpl ring %u", is_tx ? "tx" : "rx", index);
+	table[index] = NULL;
+	mqnic_event_queue_put(dev, ring->eq_ring);
+	mqnic_cpl_queue_release(ring);
 }
 
 static void
 mqnic_tx_cpl_queue_destroy(struct rte_eth_dev *dev)
 {
-	//const struct rte_memzone *tz;
-	struct mqnic_cq_ring *ring;
 	uint32_t i;
 	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
-	
-	PMD_INIT_LOG(DEBUG, "mqnic_tx_cpl_queue_destroy");
-
-	for (i = 0; i < adapter->tx_cpl_queue_count; i++){
-
-		if (adapter->tx_cpl_ring[i] != NULL) {
-			ring = adapter->tx_cpl_ring[i];
-			// deactivate queue
-			MQNIC_DIRECT_WRITE_REG(ring->hw_addr, MQNIC_CPL_QUEUE_ACTIVE_LOG_SIZE_REG, ilog2(ring->size));
-    		// disarm queue
-			MQNIC_DIRECT_WRITE_REG(ring->hw_addr, MQNIC_CPL_QUEUE_INTERRUPT_INDEX_REG, ring->eq_index);
-			MQNIC_WRITE_FLUSH(ring);
-			PMD_INIT_LOG(DEBUG, "release tx cpl ring %d", i);
-			mqnic_cpl_queue_release(ring);
-			adapter->tx_cpl_ring[i] = NULL;
-		}
 
-		rte_eth_dma_zone_free(dev, "tx_cq_ring", i);
-	}
+	PMD_INIT_LOG(DEBUG, "mqnic_tx_cpl_queue_destroy");
 
-	return;
+	for (i = 0; i < adapter->tx_cpl_queue_count; i++)
+		mqnic_cpl_queue_free(dev, true, i);
 }
 
 static void
@@ -619,99 +739,16 @@ mqnic_tx_cpl_queue_deactivate(struct rte_eth_dev *dev)
 	return;
 }
 
-static int
-mqnic_rx_cpl_queue_create(struct mqnic_if *interface)
-{
-	struct mqnic_cq_ring *ring;
-	uint32_t i;
-	
-	PMD_INIT_LOG(DEBUG, "mqnic_rx_cpl_queue_create");
-
-	for (i = 0; i < interface->rx_cpl_queue_count; i++){
-		/* Free memory prior to re-allocation if needed */
-		if (interface->rx_cpl_ring[i] != NULL) {
-			PMD_INIT_LOG(DEBUG, "release rx cpl ring %d", i);
-			mqnic_cpl_queue_release(interface->rx_cpl_ring[i]);
-			interface->rx_cpl_ring[i] = NULL;
-		}
-
-		/* allocate the event queue data structure */
-		ring = rte_zmalloc("ethdev rx cpl queue", sizeof(struct mqnic_cq_ring),
-							RTE_CACHE_LINE_SIZE);
-		if (ring == NULL){
-			PMD_INIT_LOG(ERR, "failed to alloc rx cpl queue");
-			return -ENOMEM;
-		}
-
-		// Create completion queue
-		_create_cpl_queue(ring, interface, i, false);
-
-		interface->rx_cpl_ring[i] = ring;
-	}
-
-	MQNIC_WRITE_FLUSH(interface);
-	return 0;
-}
-
-static int
-mqnic_rx_cpl_queue_alloc(struct rte_eth_dev *dev, int socket_id)
-{
-	struct mqnic_cq_ring *ring;
-	uint32_t i;
-	int ret;
-	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
-	
-	PMD_INIT_LOG(DEBUG, "mqnic_rx_cpl_queue_create");
-
-	for (i = 0; i < adapter->rx_cpl_queue_count; i++){
-		/* Free memory prior to re-allocation if needed */
-		if (adapter->rx_cpl_ring[i]->buf != NULL) {
-			return -EINVAL;
-		}
-
-		/* allocate the event queue data structure */
-		ring = adapter->rx_cpl_ring[i];
-
-		// Allocate completion queue buffer
-		if ((ret = _alloc_cpl_queue(ring, dev, i, socket_id)))
-			return ret;
-
-		// Write settings into hardware
-		mqnic_init_cpl_queue_registers(ring);
-	}
-
-	MQNIC_WRITE_FLUSH(ring);
-	return 0;
-}
-
 static void
 mqnic_rx_cpl_queue_destroy(struct rte_eth_dev *dev)
 {
-	//const struct rte_memzone *tz;
-	struct mqnic_cq_ring *ring;
 	uint32_t i;
 	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
-	
-	PMD_INIT_LOG(DEBUG, "mqnic_rx_cpl_queue_destroy");
-
-	for (i = 0; i < adapter->rx_cpl_queue_count; i++){
-		/* Free memory prior to re-allocation if needed */
-		if (adapter->rx_cpl_ring[i] != NULL) {
-			ring = adapter->rx_cpl_ring[i];
-			// deactivate queue
-			MQNIC_DIRECT_WRITE_REG(ring->hw_addr, MQNIC_CPL_QUEUE_ACTIVE_LOG_SIZE_REG, ilog2(ring->size));
-			// disarm queue
-			MQNIC_DIRECT_WRITE_REG(ring->hw_addr, MQNIC_CPL_QUEUE_INTERRUPT_INDEX_REG, ring->eq_index);
-			MQNIC_WRITE_FLUSH(ring);
-			PMD_INIT_LOG(DEBUG, "release rx cpl ring %d", i);
-			mqnic_cpl_queue_release(ring);
-			adapter->rx_cpl_ring[i] = NULL;
-		}
 
-		rte_eth_dma_zone_free(dev, "rx_cq_ring", i);
-	}
+	PMD_INIT_LOG(DEBUG, "mqnic_rx_cpl_queue_destroy");
 
-	return;
+	for (i = 0; i < adapter->rx_cpl_queue_count; i++)
+		mqnic_cpl_queue_free(dev, false, i);
 }
 
 static void
@@ -1095,16 +1132,18 @@ int mqnic_ethdev_create(struct mqnic_if *interface, int idx) {
 	adapter->if_features = interface->if_features;
 
 	adapter->event_queue_count = interface->event_queue_count;
-	for (i=0; i<adapter->event_queue_count; i++)
-		adapter->event_ring[i] = interface->event_ring[i];
+	adapter->event_ring = interface->event_ring;
 
+	adapter->tx_queue_count = interface->tx_queue_count;
 	adapter->tx_cpl_queue_count = interface->tx_cpl_queue_count;
-	for (i=0; i<adapter->tx_cpl_queue_count; i++)
-		adapter->tx_cpl_ring[i] = interface->tx_cpl_ring[i];
+	adapter->tx_cpl_ring = interface->tx_cpl_ring;
 
+	adapter->rx_queue_count = interface->rx_queue_count;
 	adapter->rx_cpl_queue_count = interface->rx_cpl_queue_count;
-	for (i=0; i<adapter->rx_cpl_queue_count; i++)
-		adapter->rx_cpl_ring[i] = interface->rx_cpl_ring[i];
+	adapter->rx_cpl_ring = interface->rx_cpl_ring;
+
+	adapter->tx_ring_mem = interface->tx_ring_mem;
+	adapter->rx_ring_mem = interface->rx_ring_mem;
 
 	adapter->sched_block_count = interface->sched_block_count;
 	for (i=0; i<adapter->sched_block_count; i++)
@@ -1114,22 +1153,7 @@ int mqnic_ethdev_create(struct mqnic_if *interface, int idx) {
 	// The rx/tx queue number is set by dpdk apps
 	/*dev->data->nb_rx_queues = interface->rx_queue_count;*/
 
-	// Alloc event queue
-	mqnic_all_event_queue_alloc(dev, 0);
-
-	// Alloc completion queue buffers
-	ret = mqnic_tx_cpl_queue_alloc(dev, 0);
-	if (ret)
-		goto fail;
-
-	ret = mqnic_rx_cpl_queue_alloc(dev, 0);
-	if (ret)
-		goto fail;
-
-	return 0;
-
-fail:
-	mqnic_netdev_destroy(dev);
+	// Event and completion queues are created at queue setup
 
 	return ret;
 }
@@ -1141,6 +1165,62 @@ void mqnic_netdev_destroy(struct rte_eth_dev *dev) {
 }
 
 
+/*
+ * Ring memory still held by queue index is returned here, the rings
+ * themselves must have been released by the caller.
+ */
+static void
+mqnic_free_queue_tables(struct mqnic_if *interface)
+{
+	u32 i;
+
+	if (interface->tx_ring_mem != NULL)
+		for (i = 0; i < interface->tx_cpl_queue_count; i++)
+			mqnic_ring_mem_free(&interface->tx_ring_mem[i]);
+	if (interface->rx_ring_mem != NULL)
+		for (i = 0; i < interface->rx_cpl_queue_count; i++)
+			mqnic_ring_mem_free(&interface->rx_ring_mem[i]);
+
+	rte_free(interface->tx_ring_mem);
+	interface->tx_ring_mem = NULL;
+	rte_free(interface->rx_ring_mem);
+	interface->rx_ring_mem = NULL;
+	rte_free(interface->event_ring);
+	interface->event_ring = NULL;
+	rte_free(interface->tx_cpl_ring);
+	interface->tx_cpl_ring = NULL;
+	rte_free(interface->rx_cpl_ring);
+	interface->rx_cpl_ring = NULL;
+}
+
+/*
+ * Allocate the event and completion ring tables of an interface, one
+ * entry per queue reported by the queue managers.
+ */
+static int
+mqnic_alloc_queue_tables(struct mqnic_if *interface)
+{
+	interface->event_ring = rte_zmalloc("mqnic event rings",
+			sizeof(*interface->event_ring) * interface->event_queue_count, 0);
+	interface->tx_cpl_ring = rte_zmalloc("mqnic tx cpl rings",
+			sizeof(*interface->tx_cpl_ring) * interface->tx_cpl_queue_count, 0);
+	interface->rx_cpl_ring = rte_zmalloc("mqnic rx cpl rings",
+			sizeof(*interface->rx_cpl_ring) * interface->rx_cpl_queue_count, 0);
+	interface->tx_ring_mem = rte_zmalloc("mqnic tx ring mem",
+			sizeof(*interface->tx_ring_mem) * interface->tx_cpl_queue_count, 0);
+	interface->rx_ring_mem = rte_zmalloc("mqnic rx ring mem",
+			sizeof(*interface->rx_ring_mem) * interface->rx_cpl_queue_count, 0);
+
+	if (interface->event_ring == NULL || interface->tx_cpl_ring == NULL ||
+	    interface->rx_cpl_ring == NULL || interface->tx_ring_mem == NULL ||
+	    interface->rx_ring_mem == NULL) {
+		mqnic_free_queue_tables(interface);
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
 int mqnic_create_if(struct rte_eth_dev *dev, int idx) {
 	int ret = 0;
 	u32 i = 0;
@@ -1311,10 +1391,12 @@ int mqnic_create_if(struct rte_eth_dev *dev, int idx) {
 	desc_block_size = mqnic_determine_desc_block_size(interface);
 	PMD_INIT_LOG(INFO, "Descriptor block size is: %d", desc_block_size);
 
-	// Create rings
-	mqnic_all_event_queue_create(interface);
-	mqnic_tx_cpl_queue_create(interface);
-	mqnic_rx_cpl_queue_create(interface);
+	// Allocate ring tables
+	ret = mqnic_alloc_queue_tables(interface);
+	if (ret) {
+		PMD_INIT_LOG(ERR, "Failed to allocate ring tables");
+		goto fail;
+	}
 
 	// Create ports
 	mqnic_all_ports_create(interface);
@@ -1338,6 +1420,7 @@ int mqnic_create_if(struct rte_eth_dev *dev, int idx) {
 	return 0;
 
 fail:
+	mqnic_free_queue_tables(interface);
 	mqnic_free_reg_block_list(interface->rb_list);
 	return ret;
 }
@@ -1402,6 +1485,131 @@ s32 mqnic_read_mac_addr(struct mqnic_hw *hw)
 	return MQNIC_SUCCESS;
 }
 
+static int
+mqnic_parse_fill_pct(const char *key, const char *value, void *args)
+{
+	u32 *pct = args;
+	char *end;
+	unsigned long val;
+
+	errno = 0;
+	val = strtoul(value, &end, 10);
+	if (errno != 0 || *end != '\0' ||
+	    val < MQNIC_MIN_TX_FILL_PCT || val > MQNIC_MAX_TX_FILL_PCT) {
+		PMD_INIT_LOG(ERR, "invalid %s value \"%s\", must be %u-%u",
+			     key, value, MQNIC_MIN_TX_FILL_PCT, MQNIC_MAX_TX_FILL_PCT);
+		return -EINVAL;
+	}
+
+	*pct = val;
+	return 0;
+}
+
+static int
+mqnic_parse_tail_batch(const char *key, const char *value, void *args)
+{
+	u32 *batch = args;
+	char *end;
+	unsigned long val;
+
+	errno = 0;
+	val = strtoul(value, &end, 10);
+	if (errno != 0 || *end != '\0' || val < 1 || val > MQNIC_MAX_RING_DESC) {
+		PMD_INIT_LOG(ERR, "invalid %s value \"%s\", must be 1-%u",
+			     key, value, MQNIC_MAX_RING_DESC);
+		return -EINVAL;
+	}
+
+	*batch = val;
+	return 0;
+}
+
+static int
+mqnic_parse_bool(const char *key, const char *value, void *args)
+{
+	u32 *flag = args;
+
+	if (strcmp(value, "0") != 0 && strcmp(value, "1") != 0) {
+		PMD_INIT_LOG(ERR, "invalid %s value \"%s\", must be 0 or 1",
+			     key, value);
+		return -EINVAL;
+	}
+
+	*flag = value[0] == '1';
+	return 0;
+}
+
+static int
+mqnic_parse_ring_size(const char *key, const char *value, void *args)
+{
+	u32 *size = args;
+	char *end;
+	unsigned long val;
+
+	errno = 0;
+	val = strtoul(value, &end, 10);
+	if (errno != 0 || *end != '\0' ||
+	    val < MQNIC_MIN_RING_DESC || val > MQNIC_MAX_RING_DESC) {
+		PMD_INIT_LOG(ERR, "invalid %s value \"%s\", must be %u-%u",
+			     key, value, MQNIC_MIN_RING_DESC, MQNIC_MAX_RING_DESC);
+		return -EINVAL;
+	}
+
+	*size = roundup_pow_of_two(val);
+	return 0;
+}
+
+static int
+mqnic_parse_devargs(struct rte_eth_dev *eth_dev)
+{
+	static const char *const valid_keys[] = {
+		MQNIC_DEVARG_TX_FILL_PCT,
+		MQNIC_DEVARG_TX_CQ_SIZE,
+		MQNIC_DEVARG_RX_CQ_SIZE,
+		MQNIC_DEVARG_EQ_SIZE,
+		MQNIC_DEVARG_EVENT_POLL,
+		MQNIC_DEVARG_CQ_TAIL_BATCH,
+		NULL
+	};
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(eth_dev->data->dev_private);
+	struct rte_devargs *devargs = eth_dev->device->devargs;
+	struct rte_kvargs *kvlist;
+	int ret;
+
+	adapter->tx_fill_pct = MQNIC_DEFAULT_TX_FILL_PCT;
+	adapter->cq_tail_batch = MQNIC_DEFAULT_CQ_TAIL_BATCH;
+
+	if (devargs == NULL || devargs->args == NULL)
+		return 0;
+
+	kvlist = rte_kvargs_parse(devargs->args, valid_keys);
+	if (kvlist == NULL) {
+		PMD_INIT_LOG(ERR, "invalid devargs \"%s\"", devargs->args);
+		return -EINVAL;
+	}
+
+	ret = rte_kvargs_process(kvlist, MQNIC_DEVARG_TX_FILL_PCT,
+				 mqnic_parse_fill_pct, &adapter->tx_fill_pct);
+	if (ret == 0)
+		ret = rte_kvargs_process(kvlist, MQNIC_DEVARG_TX_CQ_SIZE,
+					 mqnic_parse_ring_size, &adapter->tx_cq_size);
+	if (ret == 0)
+		ret = rte_kvargs_process(kvlist, MQNIC_DEVARG_RX_CQ_SIZE,
+					 mqnic_parse_ring_size, &adapter->rx_cq_size);
+	if (ret == 0)
+		ret = rte_kvargs_process(kvlist, MQNIC_DEVARG_EQ_SIZE,
+					 mqnic_parse_ring_size, &adapter->eq_size);
+	if (ret == 0)
+		ret = rte_kvargs_process(kvlist, MQNIC_DEVARG_EVENT_POLL,
+					 mqnic_parse_bool, &adapter->event_poll);
+	if (ret == 0)
+		ret = rte_kvargs_process(kvlist, MQNIC_DEVARG_CQ_TAIL_BATCH,
+					 mqnic_parse_tail_batch, &adapter->cq_tail_batch);
+
+	rte_kvargs_free(kvlist);
+	return ret;
+}
+
 int eth_mqnic_dev_init(struct rte_eth_dev *eth_dev)
 {
 	int error = 0;
@@ -1423,6 +1631,7 @@ int eth_mqnic_dev_init(struct rte_eth_dev *eth_dev)
 	eth_dev->dev_ops = &eth_mqnic_ops;
 	eth_dev->rx_pkt_burst = &eth_mqnic_recv_pkts;
 	eth_dev->tx_pkt_burst = &eth_mqnic_xmit_pkts;
+	eth_dev->tx_pkt_prepare = &eth_mqnic_prep_pkts;
 
 	/* for secondary processes, we don't initialise any further as primary
 	 * has already done this work. Only check we don't need a different
@@ -1437,6 +1646,11 @@ int eth_mqnic_dev_init(struct rte_eth_dev *eth_dev)
 	eth_dev->data->dev_flags |= RTE_ETH_DEV_AUTOFILL_QUEUE_XSTATS;
 
 	hw->dev = eth_dev;
+	mqnic_init_queue_stats_map(adapter);
+
+	error = mqnic_parse_devargs(eth_dev);
+	if (error)
+		goto err_late;
 
 	hw->hw_addr = (void *)pci_dev->mem_resource[0].addr;
 	hw->hw_regs_phys = pci_dev->mem_resource[0].phys_addr;
@@ -1497,6 +1711,30 @@ int eth_mqnic_dev_init(struct rte_eth_dev *eth_dev)
 	PMD_INIT_LOG(INFO, "IF stride: 0x%08x", hw->if_stride);
 	PMD_INIT_LOG(INFO, "IF CSR offset: 0x%08x", hw->if_csr_offset);
 
+	// Read stats block registers, the block is optional
+	hw->stats_rb = mqnic_find_reg_block(hw->rb_list, MQNIC_RB_STATS_TYPE, MQNIC_RB_STATS_VER, 0);
+	if (hw->stats_rb) {
+		hw->stats_offset = MQNIC_DIRECT_READ_REG(hw->stats_rb->regs, MQNIC_RB_STATS_REG_OFFSET);
+		hw->stats_count = MQNIC_DIRECT_READ_REG(hw->stats_rb->regs, MQNIC_RB_STATS_REG_COUNT);
+		hw->stats_stride = MQNIC_DIRECT_READ_REG(hw->stats_rb->regs, MQNIC_RB_STATS_REG_STRIDE);
+		hw->stats_flags = MQNIC_DIRECT_READ_REG(hw->stats_rb->regs, MQNIC_RB_STATS_REG_FLAGS);
+
+		PMD_INIT_LOG(INFO, "Stats offset: 0x%08x", hw->stats_offset);
+		PMD_INIT_LOG(INFO, "Stats count: %d", hw->stats_count);
+		PMD_INIT_LOG(INFO, "Stats stride: 0x%08x", hw->stats_stride);
+		PMD_INIT_LOG(INFO, "Stats flags: 0x%08x", hw->stats_flags);
+
+		if (hw->stats_stride < 4 ||
+		    hw->stats_offset + (u64)hw->stats_count * hw->stats_stride > hw->hw_regs_size) {
+			PMD_INIT_LOG(WARNING, "Invalid stats block, hardware counters disabled");
+			hw->stats_rb = NULL;
+		} else {
+			/* counters start from zero at probe */
+			mqnic_hw_stats_update(eth_dev, true);
+			memset(adapter->hw_stats, 0, sizeof(adapter->hw_stats));
+		}
+	}
+
 	// check BAR size
 	if (hw->if_count * hw->if_stride > hw->hw_regs_size) {
 		error = -EIO;
@@ -1589,19 +1827,278 @@ static struct rte_pci_driver rte_mqnic_pmd = {
 	.remove = eth_mqnic_pci_remove,
 };
 
+/*
+ * Toeplitz key of the RX hash unit. It is fixed in hardware, so it is
+ * only reported, and accepted unchanged, by the RSS ops.
+ */
+static const uint8_t mqnic_rss_key[] = {
+	0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2,
+	0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3, 0x8f, 0xb0,
+	0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4,
+	0x77, 0xcb, 0x2d, 0xa3, 0x80, 0x30, 0xf2, 0x0c,
+	0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa,
+};
+
+/*
+ * The RX queue map steers a packet to queue offset + (hash & rss_mask),
+ * with the same settings for every port of the interface. There is no
+ * indirection table in hardware, so RSS always spreads over a contiguous,
+ * power-of-two sized range of queues.
+ */
+static void
+mqnic_rss_program(struct rte_eth_dev *dev)
+{
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	struct mqnic_if *interface = adapter->interface;
+	u32 mask = adapter->rss_hf ? adapter->rss_mask : 0;
+	u32 i;
+
+	for (i = 0; i < interface->port_count; i++) {
+		mqnic_interface_set_rx_queue_map_offset(interface, i, adapter->rss_offset);
+		mqnic_interface_set_rx_queue_map_rss_mask(interface, i, mask);
+	}
+
+	PMD_INIT_LOG(DEBUG, "RSS offset %u mask 0x%x hf 0x%" PRIx64,
+		     adapter->rss_offset, mask, adapter->rss_hf);
+}
+
+static int
+mqnic_rss_check_conf(struct rte_eth_dev *dev,
+		     const struct rte_eth_rss_conf *rss_conf)
+{
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+
+	if (rss_conf->rss_hf != 0 && !(adapter->if_features & MQNIC_IF_FEATURE_RSS)) {
+		PMD_INIT_LOG(ERR, "RSS is not supported by this interface");
+		return -ENOTSUP;
+	}
+
+	if (rss_conf->rss_key != NULL &&
+	    (rss_conf->rss_key_len != sizeof(mqnic_rss_key) ||
+	     memcmp(rss_conf->rss_key, mqnic_rss_key, sizeof(mqnic_rss_key)))) {
+		PMD_INIT_LOG(ERR, "RSS hash key is fixed in hardware");
+		return -EINVAL;
+	}
+
+	if (rss_conf->rss_hf & ~MQNIC_RSS_OFFLOAD_ALL) {
+		PMD_INIT_LOG(ERR, "unsupported RSS hash functions 0x%" PRIx64,
+			     rss_conf->rss_hf & ~MQNIC_RSS_OFFLOAD_ALL);
+		return -EINVAL;
+	}
+
+	/* the hash unit has no per flow type enables, it hashes them all */
+	if (rss_conf->rss_hf != 0 && rss_conf->rss_hf != MQNIC_RSS_OFFLOAD_ALL)
+		PMD_INIT_LOG(NOTICE, "RSS hash functions 0x%" PRIx64 " requested, "
+			     "all of 0x%" PRIx64 " are hashed",
+			     rss_conf->rss_hf, (uint64_t)MQNIC_RSS_OFFLOAD_ALL);
+
+	return 0;
+}
+
+int
+eth_mqnic_rss_hash_update(struct rte_eth_dev *dev,
+			  struct rte_eth_rss_conf *rss_conf)
+{
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	int ret;
+
+	ret = mqnic_rss_check_conf(dev, rss_conf);
+	if (ret)
+		return ret;
+
+	adapter->rss_hf = rss_conf->rss_hf ? MQNIC_RSS_OFFLOAD_ALL : 0;
+	mqnic_rss_program(dev);
+
+	return 0;
+}
+
+int
+eth_mqnic_rss_hash_conf_get(struct rte_eth_dev *dev,
+			    struct rte_eth_rss_conf *rss_conf)
+{
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+
+	if (rss_conf->rss_key != NULL) {
+		if (rss_conf->rss_key_len < sizeof(mqnic_rss_key))
+			return -EINVAL;
+		memcpy(rss_conf->rss_key, mqnic_rss_key, sizeof(mqnic_rss_key));
+	}
+	rss_conf->rss_key_len = sizeof(mqnic_rss_key);
+	rss_conf->rss_hf = adapter->rss_hf;
+
+	return 0;
+}
+
+static bool
+mqnic_rss_reta_matches(const uint16_t *reta, u32 offset, u32 mask)
+{
+	u32 i;
+
+	for (i = 0; i < MQNIC_RSS_RETA_SIZE; i++)
+		if (reta[i] != offset + (i & mask))
+			return false;
+
+	return true;
+}
+
+static int
+eth_mqnic_rss_reta_update(struct rte_eth_dev *dev,
+			  struct rte_eth_rss_reta_entry64 *reta_conf,
+			  uint16_t reta_size)
+{
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	uint16_t reta[MQNIC_RSS_RETA_SIZE];
+	u32 idx, shift, mask;
+	u32 i;
+
+	if (reta_size != MQNIC_RSS_RETA_SIZE) {
+		PMD_INIT_LOG(ERR, "RETA size (%u) must be %u",
+			     reta_size, MQNIC_RSS_RETA_SIZE);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < MQNIC_RSS_RETA_SIZE; i++) {
+		idx = i / RTE_RETA_GROUP_SIZE;
+		shift = i % RTE_RETA_GROUP_SIZE;
+		if (reta_conf[idx].mask & (1ULL << shift))
+			reta[i] = reta_conf[idx].reta[shift];
+		else
+			reta[i] = adapter->rss_offset + (i & adapter->rss_mask);
+	}
+
+	/* find the offset/mask pair that reproduces the table */
+	for (mask = 0; mask < MQNIC_RSS_RETA_SIZE; mask = (mask << 1) | 1)
+		if (mqnic_rss_reta_matches(reta, reta[0], mask))
+			break;
+
+	if (mask >= MQNIC_RSS_RETA_SIZE) {
+		PMD_INIT_LOG(ERR, "RETA must map onto a contiguous power-of-two range of queues");
+		return -ENOTSUP;
+	}
+
+	if (reta[0] + mask >= dev->data->nb_rx_queues) {
+		PMD_INIT_LOG(ERR, "RETA refers to RX queue %u beyond %u",
+			     reta[0] + mask, dev->data->nb_rx_queues);
+		return -EINVAL;
+	}
+
+	adapter->rss_offset = reta[0];
+	adapter->rss_mask = mask;
+	mqnic_rss_program(dev);
+
+	return 0;
+}
+
+static int
+eth_mqnic_rss_reta_query(struct rte_eth_dev *dev,
+			 struct rte_eth_rss_reta_entry64 *reta_conf,
+			 uint16_t reta_size)
+{
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	u32 idx, shift;
+	u32 i;
+
+	if (reta_size != MQNIC_RSS_RETA_SIZE) {
+		PMD_INIT_LOG(ERR, "RETA size (%u) must be %u",
+			     reta_size, MQNIC_RSS_RETA_SIZE);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < MQNIC_RSS_RETA_SIZE; i++) {
+		idx = i / RTE_RETA_GROUP_SIZE;
+		shift = i % RTE_RETA_GROUP_SIZE;
+		if (reta_conf[idx].mask & (1ULL << shift))
+			reta_conf[idx].reta[shift] =
+				adapter->rss_offset + (i & adapter->rss_mask);
+	}
+
+	return 0;
+}
+
 static int mqnic_check_mq_mode(struct rte_eth_dev *dev)
 {
-	RTE_SET_USED(dev);
+	struct rte_eth_conf *dev_conf = &dev->data->dev_conf;
+
+	switch (dev_conf->rxmode.mq_mode) {
+	case ETH_MQ_RX_NONE:
+	case ETH_MQ_RX_RSS:
+		break;
+	default:
+		PMD_INIT_LOG(ERR, "RX mq_mode %d is not supported",
+			     dev_conf->rxmode.mq_mode);
+		return -EINVAL;
+	}
+
+	if (dev_conf->txmode.mq_mode != ETH_MQ_TX_NONE) {
+		PMD_INIT_LOG(ERR, "TX mq_mode %d is not supported",
+			     dev_conf->txmode.mq_mode);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/*
+ * Spread RX traffic over the largest power-of-two number of queues that
+ * fits in nb_rx_queues when RSS is requested, otherwise steer everything
+ * to queue 0.
+ */
+static int
+mqnic_rss_configure(struct rte_eth_dev *dev)
+{
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	struct rte_eth_rss_conf *rss_conf = &dev->data->dev_conf.rx_adv_conf.rss_conf;
+	uint16_t nb_rx_queues = dev->data->nb_rx_queues;
+	u32 nb_rss;
+	int ret;
+
+	adapter->rss_offset = 0;
+	adapter->rss_mask = 0;
+	adapter->rss_hf = 0;
+
+	if (dev->data->dev_conf.rxmode.mq_mode == ETH_MQ_RX_RSS && nb_rx_queues > 1) {
+		ret = mqnic_rss_check_conf(dev, rss_conf);
+		if (ret)
+			return ret;
+
+		nb_rss = RTE_MIN(rte_align32prevpow2(nb_rx_queues),
+				 (u32)MQNIC_RSS_RETA_SIZE);
+		if (nb_rss != nb_rx_queues)
+			PMD_INIT_LOG(WARNING, "RSS spreads over %u of %u RX queues",
+				     nb_rss, nb_rx_queues);
+
+		adapter->rss_hf = rss_conf->rss_hf ? MQNIC_RSS_OFFLOAD_ALL : 0;
+		adapter->rss_mask = nb_rss - 1;
+	}
+
+	mqnic_rss_program(dev);
+
 	return 0;
 }
 
 static int
 eth_mqnic_configure(struct rte_eth_dev *dev)
 {
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
 	int ret;
 
 	PMD_INIT_FUNC_TRACE();
 
+	/* an event queue raises a single vector, it cannot serve two RX queues */
+	if (dev->data->dev_conf.intr_conf.rxq &&
+	    dev->data->nb_rx_queues > adapter->event_queue_count) {
+		PMD_INIT_LOG(ERR, "RX interrupts support at most %u RX queues",
+			     adapter->event_queue_count);
+		return -EINVAL;
+	}
+
+	/* rx_queue_intr_enable drops the events the poll API would report */
+	if (dev->data->dev_conf.intr_conf.rxq && adapter->event_poll) {
+		PMD_INIT_LOG(ERR, "RX interrupts and %s are exclusive",
+			     MQNIC_DEVARG_EVENT_POLL);
+		return -EINVAL;
+	}
+
 	/* multipe queue mode checking */
 	ret  = mqnic_check_mq_mode(dev);
 	if (ret != 0) {
@@ -1609,11 +2106,155 @@ eth_mqnic_configure(struct rte_eth_dev *dev)
 		return ret;
 	}
 
+	ret = mqnic_rss_configure(dev);
+	if (ret != 0) {
+		PMD_INIT_LOG(ERR, "mqnic_rss_configure fails with %d.", ret);
+		return ret;
+	}
+
 	PMD_INIT_FUNC_TRACE();
 
 	return 0;
 }
 
+static void
+mqnic_rxq_intr_teardown(struct rte_eth_dev *dev)
+{
+	struct rte_intr_handle *intr_handle = &RTE_ETH_DEV_TO_PCI(dev)->intr_handle;
+
+	if (intr_handle->intr_vec == NULL)
+		return;
+
+	rte_intr_disable(intr_handle);
+	rte_intr_efd_disable(intr_handle);
+	rte_free(intr_handle->intr_vec);
+	intr_handle->intr_vec = NULL;
+}
+
+/*
+ * Map every RX queue to its own MSI-X vector. Event queue i serves
+ * completion queue i, so its interrupt index is the vector of RX queue i,
+ * see mqnic_all_event_queue_active().
+ */
+static int
+mqnic_rxq_intr_setup(struct rte_eth_dev *dev)
+{
+	struct rte_intr_handle *intr_handle = &RTE_ETH_DEV_TO_PCI(dev)->intr_handle;
+	uint16_t nb_rxq = dev->data->nb_rx_queues;
+	uint32_t base = RTE_INTR_VEC_ZERO_OFFSET;
+	uint32_t vec;
+	uint16_t i;
+	int ret;
+
+	if (!dev->data->dev_conf.intr_conf.rxq)
+		return 0;
+
+	if (!rte_intr_cap_multiple(intr_handle)) {
+		PMD_INIT_LOG(ERR, "RX interrupts need MSI-X, use vfio-pci");
+		return -ENOTSUP;
+	}
+
+	ret = rte_intr_efd_enable(intr_handle, nb_rxq);
+	if (ret) {
+		PMD_INIT_LOG(ERR, "failed to enable %u RX interrupt event fds", nb_rxq);
+		return ret;
+	}
+
+	if (intr_handle->intr_vec == NULL) {
+		intr_handle->intr_vec = rte_zmalloc("intr_vec", nb_rxq * sizeof(int), 0);
+		if (intr_handle->intr_vec == NULL) {
+			PMD_INIT_LOG(ERR, "failed to allocate %u rx_queues intr_vec", nb_rxq);
+			rte_intr_efd_disable(intr_handle);
+			return -ENOMEM;
+		}
+	}
+
+	// vector 0 stays with the device when there are enough vectors
+	if (rte_intr_allow_others(intr_handle))
+		base = RTE_INTR_VEC_RXTX_OFFSET;
+	vec = base;
+	for (i = 0; i < nb_rxq; i++) {
+		intr_handle->intr_vec[i] = vec;
+		if (vec < base + intr_handle->nb_efd - 1)
+			vec++;
+	}
+
+	ret = rte_intr_enable(intr_handle);
+	if (ret) {
+		PMD_INIT_LOG(ERR, "failed to enable RX interrupts");
+		mqnic_rxq_intr_teardown(dev);
+	}
+	return ret;
+}
+
+/*
+ * Find the completion ring behind an RX queue interrupt. The interrupt ops
+ * only apply to a port started with intr_conf.rxq: otherwise the event
+ * queue has no vector of its own, the hardware tail of the completion ring
+ * may lag behind and draining the event queue would lose what
+ * rte_pmd_mqnic_poll_events() has to report.
+ */
+static int
+mqnic_rxq_intr_cq(struct rte_eth_dev *dev, uint16_t queue_id,
+		  struct mqnic_cq_ring **cq_ring)
+{
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	struct rte_intr_handle *intr_handle = &RTE_ETH_DEV_TO_PCI(dev)->intr_handle;
+
+	if (!dev->data->dev_conf.intr_conf.rxq || intr_handle->intr_vec == NULL)
+		return -ENOTSUP;
+
+	if (adapter->rx_cpl_ring == NULL || adapter->rx_cpl_ring[queue_id] == NULL)
+		return -EINVAL;
+
+	*cq_ring = adapter->rx_cpl_ring[queue_id];
+	return 0;
+}
+
+/*
+ * Events only carry the wakeup: drop the ones left over, then re-arm the
+ * event queue, which raises its vector once per arming, and the completion
+ * queue, which posts an event as soon as it holds a completion.
+ */
+static int
+eth_mqnic_rx_queue_intr_enable(struct rte_eth_dev *dev, uint16_t queue_id)
+{
+	struct mqnic_cq_ring *cq_ring;
+	struct mqnic_eq_ring *eq_ring;
+	int ret;
+
+	ret = mqnic_rxq_intr_cq(dev, queue_id, &cq_ring);
+	if (ret)
+		return ret;
+	eq_ring = cq_ring->eq_ring;
+
+	mqnic_eq_read_head_ptr(eq_ring);
+	eq_ring->tail_ptr = eq_ring->head_ptr;
+	mqnic_eq_write_tail_ptr(eq_ring);
+
+	mqnic_arm_eq(eq_ring);
+	mqnic_arm_cq(cq_ring);
+	rte_intr_ack(&RTE_ETH_DEV_TO_PCI(dev)->intr_handle);
+
+	return 0;
+}
+
+static int
+eth_mqnic_rx_queue_intr_disable(struct rte_eth_dev *dev, uint16_t queue_id)
+{
+	struct mqnic_cq_ring *cq_ring;
+	int ret;
+
+	ret = mqnic_rxq_intr_cq(dev, queue_id, &cq_ring);
+	if (ret)
+		return ret;
+
+	// disarm queue
+	MQNIC_DIRECT_WRITE_REG(cq_ring->hw_addr, MQNIC_CPL_QUEUE_INTERRUPT_INDEX_REG, cq_ring->eq_index);
+
+	return 0;
+}
+
 static int eth_mqnic_start(struct rte_eth_dev *dev)
 {
 	struct mqnic_adapter *adapter =
@@ -1624,6 +2265,12 @@ static int eth_mqnic_start(struct rte_eth_dev *dev)
 	PMD_INIT_FUNC_TRACE();
 	adapter->stopped = 0;
 
+	ret = mqnic_rxq_intr_setup(dev);
+	if (ret) {
+		PMD_INIT_LOG(ERR, "Unable to set up RX interrupts");
+		return ret;
+	}
+
 	mqnic_all_event_queue_active(dev);
 	mqnic_rx_cpl_queue_active(dev);
 
@@ -1631,19 +2278,17 @@ static int eth_mqnic_start(struct rte_eth_dev *dev)
 	ret = eth_mqnic_rx_init(dev);
 	if (ret) {
 		PMD_INIT_LOG(ERR, "Unable to initialize RX hardware");
-		mqnic_dev_clear_queues(dev);
-		return ret;
+		goto error;
 	}
 
 	mqnic_tx_cpl_queue_active(dev);
 	ret = eth_mqnic_tx_init(dev);
 	if (ret) {
 		PMD_INIT_LOG(ERR, "Unable to initialize TX hardware");
-		mqnic_dev_clear_queues(dev);
-		return ret;
+		goto error;
 	}
 
-	mqnic_set_interface_mtu(interface, 1500);
+	mqnic_set_interface_mtu(interface, mqnic_rx_max_frame_len(dev) - MQNIC_ETH_OVERHEAD);
 	mqnic_activate_first_sched_block(dev);
 	adapter->port_up = true;
 
@@ -1656,6 +2301,17 @@ static int eth_mqnic_start(struct rte_eth_dev *dev)
 	PMD_INIT_LOG(DEBUG, "<<");
 
 	return 0;
+
+error:
+	/* undo what was activated, in the order of eth_mqnic_stop */
+	mqnic_dev_deactive_queues(dev);
+	mqnic_tx_cpl_queue_deactivate(dev);
+	mqnic_rx_cpl_queue_deactivate(dev);
+	mqnic_all_event_queue_deactivate(dev);
+	mqnic_rxq_intr_teardown(dev);
+	mqnic_dev_clear_queues(dev);
+	adapter->stopped = true;
+	return ret;
 }
 
 /*********************************************************************
@@ -1678,6 +2334,7 @@ eth_mqnic_stop(struct rte_eth_dev *dev)
 	mqnic_tx_cpl_queue_deactivate(dev);
 	mqnic_rx_cpl_queue_deactivate(dev);
 	mqnic_all_event_queue_deactivate(dev);
+	mqnic_rxq_intr_teardown(dev);
 
 	rte_delay_us_sleep(10000);
 	mqnic_dev_clear_queues(dev);
@@ -1710,6 +2367,13 @@ int eth_mqnic_close(struct rte_eth_dev *dev)
 	mqnic_rx_cpl_queue_destroy(dev);
 	mqnic_all_event_queue_destroy(dev);
 
+	mqnic_free_queue_tables(interface);
+	adapter->event_ring = NULL;
+	adapter->tx_cpl_ring = NULL;
+	adapter->rx_cpl_ring = NULL;
+	adapter->tx_ring_mem = NULL;
+	adapter->rx_ring_mem = NULL;
+
 	memset(&link, 0, sizeof(link));
 	rte_eth_linkstatus_set(dev, &link);
 
@@ -1746,38 +2410,261 @@ static int
 eth_mqnic_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *rte_stats)
 {
 	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	struct mqnic_rx_queue *rxq;
+	struct mqnic_tx_queue *txq;
+	uint16_t i;
+	uint8_t idx;
 
 	if (rte_stats == NULL)
 		return -EINVAL;
 
-	rte_stats->ipackets = adapter->ipackets;
-	rte_stats->opackets = adapter->opackets;
-	rte_stats->ibytes   = adapter->ibytes;
-	rte_stats->obytes   = adapter->obytes;
+	for (i = 0; i < dev->data->nb_rx_queues; i++) {
+		rxq = dev->data->rx_queues[i];
+		if (rxq == NULL)
+			continue;
+
+		rte_stats->ipackets += rxq->stats.packets;
+		rte_stats->ibytes += rxq->stats.bytes;
+		rte_stats->ierrors += rxq->stats.errors;
+
+		idx = adapter->rx_queue_stats_map[i];
+		if (idx == MQNIC_QUEUE_STATS_UNMAPPED)
+			continue;
+		rte_stats->q_ipackets[idx] += rxq->stats.packets;
+		rte_stats->q_ibytes[idx] += rxq->stats.bytes;
+		rte_stats->q_errors[idx] += rxq->stats.errors;
+	}
+
+	for (i = 0; i < dev->data->nb_tx_queues; i++) {
+		txq = dev->data->tx_queues[i];
+		if (txq == NULL)
+			continue;
+
+		rte_stats->opackets += txq->stats.packets;
+		rte_stats->obytes += txq->stats.bytes;
+		rte_stats->oerrors += txq->stats.errors;
+
+		idx = adapter->tx_queue_stats_map[i];
+		if (idx == MQNIC_QUEUE_STATS_UNMAPPED)
+			continue;
+		rte_stats->q_opackets[idx] += txq->stats.packets;
+		rte_stats->q_obytes[idx] += txq->stats.bytes;
+	}
 
 	return 0;
 }
 
 static int
 eth_mqnic_stats_reset(struct rte_eth_dev *dev)
+{
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	struct mqnic_rx_queue *rxq;
+	struct mqnic_tx_queue *txq;
+	uint16_t i;
+
+	/* take a fresh snapshot as the new base of the hardware counters */
+	mqnic_hw_stats_update(dev, true);
+	memset(adapter->hw_stats, 0, sizeof(adapter->hw_stats));
+
+	for (i = 0; i < dev->data->nb_rx_queues; i++) {
+		rxq = dev->data->rx_queues[i];
+		if (rxq != NULL)
+			memset(&rxq->stats, 0, sizeof(rxq->stats));
+	}
+
+	for (i = 0; i < dev->data->nb_tx_queues; i++) {
+		txq = dev->data->tx_queues[i];
+		if (txq != NULL)
+			memset(&txq->stats, 0, sizeof(txq->stats));
+	}
+
+	return 0;
+}
+
+/*
+ * Select the q_* counters of rte_eth_stats a queue is accounted in.
+ * Several queues may share one counter index.
+ */
+static int
+eth_mqnic_queue_stats_mapping_set(struct rte_eth_dev *dev, uint16_t queue_id,
+				  uint8_t stat_idx, uint8_t is_rx)
 {
 	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
 
-	adapter->ipackets = 0;
-	adapter->opackets = 0;
-	adapter->ibytes = 0;
-	adapter->obytes = 0;
+	if (stat_idx >= RTE_ETHDEV_QUEUE_STAT_CNTRS)
+		return -EINVAL;
+
+	PMD_INIT_LOG(DEBUG, "Setting port %d, %s queue_id %d to stat index %d",
+		     dev->data->port_id, is_rx ? "RX" : "TX", queue_id, stat_idx);
+
+	if (is_rx)
+		adapter->rx_queue_stats_map[queue_id] = stat_idx;
+	else
+		adapter->tx_queue_stats_map[queue_id] = stat_idx;
 
 	return 0;
 }
 
+static uint64_t
+mqnic_hw_stat_read(struct mqnic_hw *hw, u32 index)
+{
+	u8 *addr = hw->hw_addr + hw->stats_offset + index * hw->stats_stride;
+	u32 hi, lo;
+
+	if (index >= hw->stats_count)
+		return 0;
+
+	if (hw->stats_stride < 8)
+		return MQNIC_DIRECT_READ_REG(addr, 0);
+
+	// the low word may carry into the high word between the two reads
+	do {
+		hi = MQNIC_DIRECT_READ_REG(addr, 4);
+		lo = MQNIC_DIRECT_READ_REG(addr, 0);
+	} while (hi != MQNIC_DIRECT_READ_REG(addr, 4));
+
+	return (uint64_t)hi << 32 | lo;
+}
+
+/*
+ * Refresh the snapshot of the hardware counters, at most once per
+ * MQNIC_HW_STATS_INTERVAL_MS unless forced. Counters are accumulated from
+ * the difference to the previous read, which widens 32-bit counters to
+ * 64 bits and makes a reset a matter of clearing the snapshot.
+ */
+static void
+mqnic_hw_stats_update(struct rte_eth_dev *dev, bool force)
+{
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	struct mqnic_hw *hw = &adapter->hw;
+	uint64_t now = rte_get_timer_cycles();
+	uint64_t mask;
+	uint64_t raw;
+	unsigned int i;
+
+	RTE_BUILD_BUG_ON(MQNIC_NB_HW_XSTATS > MQNIC_HW_XSTATS_MAX);
+
+	if (hw->stats_rb == NULL)
+		return;
+
+	if (!force && now - adapter->hw_stats_tsc <
+	    rte_get_timer_hz() / 1000 * MQNIC_HW_STATS_INTERVAL_MS)
+		return;
+	adapter->hw_stats_tsc = now;
+
+	mask = hw->stats_stride >= 8 ? UINT64_MAX : UINT32_MAX;
+	for (i = 0; i < MQNIC_NB_HW_XSTATS; i++) {
+		raw = mqnic_hw_stat_read(hw, rte_mqnic_hw_stats_strings[i].index);
+		adapter->hw_stats[i] += (raw - adapter->hw_stats_raw[i]) & mask;
+		adapter->hw_stats_raw[i] = raw;
+	}
+}
+
+static unsigned int
+mqnic_nb_hw_xstats(struct rte_eth_dev *dev)
+{
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+
+	return adapter->hw.stats_rb != NULL ? MQNIC_NB_HW_XSTATS : 0;
+}
+
+static int
+eth_mqnic_xstats_get_names(struct rte_eth_dev *dev,
+			   struct rte_eth_xstat_name *xstats_names,
+			   unsigned int size)
+{
+	unsigned int nb = mqnic_nb_hw_xstats(dev);
+	unsigned int i;
+
+	if (xstats_names == NULL)
+		return nb;
+
+	if (size < nb)
+		return nb;
+
+	for (i = 0; i < nb; i++)
+		strlcpy(xstats_names[i].name, rte_mqnic_hw_stats_strings[i].name,
+			sizeof(xstats_names[i].name));
+
+	return nb;
+}
+
+static int
+eth_mqnic_xstats_get(struct rte_eth_dev *dev, struct rte_eth_xstat *xstats,
+		     unsigned int n)
+{
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	unsigned int nb = mqnic_nb_hw_xstats(dev);
+	unsigned int i;
+
+	if (n < nb)
+		return nb;
+
+	if (!xstats)
+		return 0;
+
+	mqnic_hw_stats_update(dev, false);
+
+	for (i = 0; i < nb; i++) {
+		xstats[i].id = i;
+		xstats[i].value = adapter->hw_stats[i];
+	}
+
+	return nb;
+}
+
+static int
+eth_mqnic_xstats_get_by_id(struct rte_eth_dev *dev, const uint64_t *ids,
+			   uint64_t *values, unsigned int n)
+{
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	unsigned int nb = mqnic_nb_hw_xstats(dev);
+	unsigned int i;
+
+	if (!ids) {
+		if (values == NULL || n < nb)
+			return nb;
+
+		mqnic_hw_stats_update(dev, false);
+		for (i = 0; i < nb; i++)
+			values[i] = adapter->hw_stats[i];
+		return nb;
+	}
+
+	mqnic_hw_stats_update(dev, false);
+	for (i = 0; i < n; i++) {
+		if (ids[i] >= nb) {
+			PMD_INIT_LOG(ERR, "id value isn't valid");
+			return -EINVAL;
+		}
+		values[i] = adapter->hw_stats[ids[i]];
+	}
+
+	return n;
+}
+
+/* By default queue i is accounted in counter i, if there is one. */
+static void
+mqnic_init_queue_stats_map(struct mqnic_adapter *adapter)
+{
+	uint16_t i;
+
+	for (i = 0; i < RTE_MAX_QUEUES_PER_PORT; i++) {
+		adapter->rx_queue_stats_map[i] = i < RTE_ETHDEV_QUEUE_STAT_CNTRS ?
+			i : MQNIC_QUEUE_STATS_UNMAPPED;
+		adapter->tx_queue_stats_map[i] = adapter->rx_queue_stats_map[i];
+	}
+}
+
 // TODO: Set default rx/tx queue sizes
 static int
 eth_mqnic_infos_get(struct rte_eth_dev *dev, struct rte_eth_dev_info *dev_info)
 {
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
 
 	dev_info->min_rx_bufsize = 256; /* See BSIZE field of RCTL register. */
-	dev_info->max_rx_pktlen  = 0x1000;//0x3FFF; /* See RLPML register. */
+	dev_info->max_rx_pktlen  = adapter->interface->max_rx_mtu ?
+		adapter->interface->max_rx_mtu : 0x1000;
 	dev_info->max_mac_addrs = 1;//hw->mac.rar_entry_count;
 	dev_info->rx_queue_offload_capa = mqnic_get_rx_queue_offloads_capa(dev);
 	dev_info->rx_offload_capa = mqnic_get_rx_port_offloads_capa(dev) |
@@ -1786,12 +2673,19 @@ eth_mqnic_infos_get(struct rte_eth_dev *dev, struct rte_eth_dev_info *dev_info)
 	dev_info->tx_offload_capa = mqnic_get_tx_port_offloads_capa(dev) |
 				    dev_info->tx_queue_offload_capa;
 
-	dev_info->max_rx_queues = 16;
-	dev_info->max_tx_queues = 16;
+	// Each queue is served by the completion queue of the same index
+	dev_info->max_rx_queues = RTE_MIN(RTE_MIN(adapter->rx_queue_count,
+			adapter->rx_cpl_queue_count), RTE_MAX_QUEUES_PER_PORT);
+	dev_info->max_tx_queues = RTE_MIN(RTE_MIN(adapter->tx_queue_count,
+			adapter->tx_cpl_queue_count), RTE_MAX_QUEUES_PER_PORT);
 
 	dev_info->max_vmdq_pools = 0;
 
-	dev_info->hash_key_size = IGB_HKEY_MAX_INDEX * sizeof(uint32_t);
+	if (adapter->if_features & MQNIC_IF_FEATURE_RSS) {
+		dev_info->hash_key_size = sizeof(mqnic_rss_key);
+		dev_info->reta_size = MQNIC_RSS_RETA_SIZE;
+		dev_info->flow_type_rss_offloads = MQNIC_RSS_OFFLOAD_ALL;
+	}
 
 	dev_info->default_rxconf = (struct rte_eth_rxconf) {
 		.rx_thresh = {
@@ -1799,7 +2693,7 @@ eth_mqnic_infos_get(struct rte_eth_dev *dev, struct rte_eth_dev_info *dev_info)
 			.hthresh = IGB_DEFAULT_RX_HTHRESH,
 			.wthresh = IGB_DEFAULT_RX_WTHRESH,
 		},
-		.rx_free_thresh = IGB_DEFAULT_RX_FREE_THRESH,
+		.rx_free_thresh = MQNIC_DEFAULT_RX_FREE_THRESH,
 		.rx_drop_en = 0,
 		.offloads = 0,
 	};
@@ -1810,6 +2704,7 @@ eth_mqnic_infos_get(struct rte_eth_dev *dev, struct rte_eth_dev_info *dev_info)
 			.hthresh = IGB_DEFAULT_TX_HTHRESH,
 			.wthresh = IGB_DEFAULT_TX_WTHRESH,
 		},
+		.tx_free_thresh = MQNIC_DEFAULT_TX_FREE_THRESH,
 		.offloads = 0,
 	};
 
@@ -1848,6 +2743,10 @@ eth_mqnic_supported_ptypes_get(struct rte_eth_dev *dev)
 	if (dev->rx_pkt_burst == eth_mqnic_recv_pkts ||
 	    dev->rx_pkt_burst == eth_mqnic_recv_scattered_pkts)
 		return ptypes;
+#ifdef CC_AVX2_SUPPORT
+	if (dev->rx_pkt_burst == eth_mqnic_recv_pkts_vec_avx2)
+		return ptypes;
+#endif
 	return NULL;
 }
 
@@ -1889,6 +2788,37 @@ static int
 eth_mqnic_mtu_set(struct rte_eth_dev *dev, uint16_t mtu)
 {
 	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	struct rte_eth_dev_info dev_info;
+	struct mqnic_rx_queue *rxq;
+	uint32_t frame_size = mtu + MQNIC_ETH_OVERHEAD;
+	uint16_t i;
+	int ret;
+
+	ret = eth_mqnic_infos_get(dev, &dev_info);
+	if (ret != 0)
+		return ret;
+
+	if (mtu < RTE_ETHER_MIN_MTU || frame_size > dev_info.max_rx_pktlen)
+		return -EINVAL;
+
+	/* the frame must fit in the descriptor block of every RX queue */
+	for (i = 0; i < dev->data->nb_rx_queues; i++) {
+		rxq = dev->data->rx_queues[i];
+		if (rxq != NULL &&
+		    frame_size > rxq->desc_block_size * rxq->rx_buf_len) {
+			PMD_INIT_LOG(ERR, "mtu %u does not fit in RX queue %u "
+				     "buffers, reconfigure with scatter or larger mbufs",
+				     mtu, i);
+			return -EINVAL;
+		}
+	}
+
+	if (frame_size > RTE_ETHER_MAX_LEN)
+		dev->data->dev_conf.rxmode.offloads |= DEV_RX_OFFLOAD_JUMBO_FRAME;
+	else
+		dev->data->dev_conf.rxmode.offloads &= ~DEV_RX_OFFLOAD_JUMBO_FRAME;
+	dev->data->dev_conf.rxmode.max_rx_pkt_len = frame_size;
+
 	mqnic_set_interface_mtu(adapter->interface, mtu);
 	return 0;
 }
@@ -1909,6 +2839,109 @@ u32 mqnic_port_get_rx_status(struct mqnic_port *port)
 	return MQNIC_DIRECT_READ_REG(port->port_ctrl_rb->regs, MQNIC_RB_PORT_CTRL_REG_RX_STATUS);
 }
 
+static bool
+is_mqnic_supported(struct rte_eth_dev *dev)
+{
+	return dev->device->driver == &rte_mqnic_pmd.driver;
+}
+
+int
+rte_pmd_mqnic_get_event_queue(uint16_t port_id, uint16_t queue_id,
+			      uint8_t is_tx)
+{
+	struct rte_eth_dev *dev;
+	struct mqnic_adapter *adapter;
+	struct mqnic_cq_ring *cq_ring;
+
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(port_id, -ENODEV);
+	dev = &rte_eth_devices[port_id];
+	if (!is_mqnic_supported(dev))
+		return -ENOTSUP;
+
+	adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	if (is_tx ? queue_id >= dev->data->nb_tx_queues :
+		    queue_id >= dev->data->nb_rx_queues)
+		return -EINVAL;
+
+	cq_ring = is_tx ? adapter->tx_cpl_ring[queue_id] : adapter->rx_cpl_ring[queue_id];
+	if (cq_ring == NULL)
+		return -EINVAL;
+
+	return cq_ring->eq_index;
+}
+
+/*
+ * Each event names the completion queue that posted it, which carries the
+ * index of the queue it serves. A completion queue posts one event per
+ * arming and is re-armed by the burst that drains it, so events neither
+ * repeat nor get lost.
+ */
+int
+rte_pmd_mqnic_poll_events(uint16_t port_id, uint16_t eq_id,
+			  struct rte_pmd_mqnic_event *events,
+			  uint16_t nb_events)
+{
+	struct rte_eth_dev *dev;
+	struct mqnic_adapter *adapter;
+	struct mqnic_eq_ring *ring;
+	volatile struct mqnic_event *event;
+	uint32_t eq_tail_ptr;
+	uint16_t nb = 0;
+
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(port_id, -ENODEV);
+	dev = &rte_eth_devices[port_id];
+	if (!is_mqnic_supported(dev))
+		return -ENOTSUP;
+
+	adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	if (!adapter->event_poll)
+		return -ENOTSUP;
+	if (eq_id >= adapter->event_queue_count)
+		return -EINVAL;
+
+	/* no queue is mapped to this event queue, or the port is stopped */
+	ring = adapter->event_ring[eq_id];
+	if (ring == NULL || !ring->active)
+		return 0;
+
+	mqnic_eq_read_head_ptr(ring);
+
+	eq_tail_ptr = ring->tail_ptr;
+	while (eq_tail_ptr != ring->head_ptr && nb < nb_events) {
+		event = (volatile struct mqnic_event *)(ring->buf +
+			(eq_tail_ptr & ring->size_mask) * ring->stride);
+
+		switch (event->type) {
+		case MQNIC_EVENT_TYPE_TX_CPL:
+		case MQNIC_EVENT_TYPE_RX_CPL:
+			events[nb].queue_id = event->source;
+			events[nb].is_tx = event->type == MQNIC_EVENT_TYPE_TX_CPL;
+			nb++;
+			break;
+		default:
+			PMD_RX_LOG(DEBUG, "unknown event type 0x%04x on event queue %u",
+				   event->type, eq_id);
+			break;
+		}
+
+		eq_tail_ptr++;
+	}
+
+	if (eq_tail_ptr != ring->tail_ptr) {
+		ring->tail_ptr = eq_tail_ptr;
+		mqnic_eq_write_tail_ptr(ring);
+	}
+
+	return nb;
+}
+
 RTE_PMD_REGISTER_PCI(net_mqnic, rte_mqnic_pmd);
 RTE_PMD_REGISTER_PCI_TABLE(net_mqnic, pci_id_mqnic_map);
 RTE_PMD_REGISTER_KMOD_DEP(net_mqnic, "* uio_pci_generic | vfio");
+RTE_PMD_REGISTER_PARAM_STRING(net_mqnic,
+			      MQNIC_DEVARG_TX_FILL_PCT "=<1-100> "
+			      MQNIC_DEVARG_TX_CQ_SIZE "=<32-32768> "
+			      MQNIC_DEVARG_RX_CQ_SIZE "=<32-32768> "
+			      MQNIC_DEVARG_EQ_SIZE "=<32-32768> "
+			      MQNIC_DEVARG_EVENT_POLL "=<0|1> "
+			      MQNIC_DEVARG_CQ_TAIL_BATCH "=<1-32768>");
@@ -19,12 +19,13 @@
 
 #define MQNIC_MAX_FRAGS 8
 
-// TODO: revise to default after debug
-#define MQNIC_MAX_EVENT_RINGS   2//256
-#define MQNIC_MAX_TX_RINGS      16//8192
-#define MQNIC_MAX_TX_CPL_RINGS  16//8192
-#define MQNIC_MAX_RX_RINGS     16// 8192
-#define MQNIC_MAX_RX_CPL_RINGS  16//8192
+// Upper bounds on the queue counts read from the queue managers, the
+// per-interface ring tables are sized from the reported counts
+#define MQNIC_MAX_EVENT_RINGS   256
+#define MQNIC_MAX_TX_RINGS      8192
+#define MQNIC_MAX_TX_CPL_RINGS  8192
+#define MQNIC_MAX_RX_RINGS      8192
+#define MQNIC_MAX_RX_CPL_RINGS  8192
 
 #define MQNIC_MAX_I2C_ADAPTERS 4
 
@@ -108,6 +109,32 @@
 #define MQNIC_RB_STATS_REG_STRIDE  0x14
 #define MQNIC_RB_STATS_REG_FLAGS   0x18
 
+// stats block counter indices, DMA engine
+#define MQNIC_STATS_DMA_RD_OP_COUNT       64
+#define MQNIC_STATS_DMA_RD_OP_BYTES       65
+#define MQNIC_STATS_DMA_RD_OP_LATENCY     66
+#define MQNIC_STATS_DMA_RD_OP_ERROR       67
+#define MQNIC_STATS_DMA_RD_REQ_COUNT      68
+#define MQNIC_STATS_DMA_RD_REQ_LATENCY    69
+#define MQNIC_STATS_DMA_RD_REQ_TIMEOUT    70
+#define MQNIC_STATS_DMA_RD_OP_TABLE_FULL  71
+#define MQNIC_STATS_DMA_RD_NO_TAGS        72
+#define MQNIC_STATS_DMA_RD_TX_NO_CREDIT   73
+#define MQNIC_STATS_DMA_RD_TX_LIMIT       74
+#define MQNIC_STATS_DMA_RD_TX_STALL       75
+#define MQNIC_STATS_DMA_WR_OP_COUNT       80
+#define MQNIC_STATS_DMA_WR_OP_BYTES       81
+#define MQNIC_STATS_DMA_WR_OP_LATENCY     82
+#define MQNIC_STATS_DMA_WR_OP_ERROR       83
+#define MQNIC_STATS_DMA_WR_REQ_COUNT      84
+#define MQNIC_STATS_DMA_WR_REQ_LATENCY    85
+#define MQNIC_STATS_DMA_WR_REQ_TIMEOUT    86
+#define MQNIC_STATS_DMA_WR_OP_TABLE_FULL  87
+#define MQNIC_STATS_DMA_WR_NO_TAGS        88
+#define MQNIC_STATS_DMA_WR_TX_NO_CREDIT   89
+#define MQNIC_STATS_DMA_WR_TX_LIMIT       90
+#define MQNIC_STATS_DMA_WR_TX_STALL       91
+
 #define MQNIC_RB_PHC_TYPE               0x0000C080
 #define MQNIC_RB_PHC_VER                0x00000100
 #define MQNIC_RB_PHC_REG_CTRL           0x0C
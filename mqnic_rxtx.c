@@ -74,66 +74,191 @@ mqnic_is_tx_queue_full(const struct mqnic_tx_queue *txq)
     return txq->head_ptr - txq->clean_tail_ptr >= txq->full_size;
 }
 
-static void 
-mqnic_tx_read_tail_ptr(struct mqnic_tx_queue *txq)
+/*
+ * Size of a completion ring no devarg sets: the ring it serves, or room
+ * for cq_tail_batch completions beyond what the queue can have outstanding
+ * when the completion ring is never armed.
+ */
+static uint32_t
+mqnic_default_cq_size(const struct mqnic_adapter *adapter, uint32_t ring_size,
+		uint32_t outstanding, bool armed)
 {
-    txq->tail_ptr += (MQNIC_DIRECT_READ_REG(txq->hw_tail_ptr, 0) - txq->tail_ptr) & txq->hw_ptr_mask;
-	PMD_TX_LOG(DEBUG, "get txq->tail_ptr = %d", txq->tail_ptr);
+	if (armed || ring_size - outstanding >= adapter->cq_tail_batch)
+		return ring_size;
+
+	return RTE_MIN(roundup_pow_of_two(outstanding + adapter->cq_tail_batch),
+		       (uint32_t)MQNIC_MAX_RING_DESC);
 }
 
-static void 
-mqnic_cq_read_head_ptr(struct mqnic_cq_ring *ring)
+/*
+ * The tail pointer of an armed completion ring must be current when it is
+ * armed. Otherwise it is written back every tail_batch completions, which
+ * the hardware never finds full as long as the queue cannot have more than
+ * size - tail_batch completions outstanding.
+ */
+static void
+mqnic_cq_set_tail_batch(const struct mqnic_adapter *adapter,
+		struct mqnic_cq_ring *ring, uint32_t outstanding, bool armed)
 {
-    ring->head_ptr += (MQNIC_DIRECT_READ_REG(ring->hw_head_ptr, 0) - ring->head_ptr) & ring->hw_ptr_mask;
-	PMD_TX_LOG(DEBUG, "get cq ring->head_ptr = %d", ring->head_ptr);
+	if (armed || ring->size <= outstanding)
+		ring->tail_batch = 1;
+	else
+		ring->tail_batch = RTE_MIN(adapter->cq_tail_batch, ring->size - outstanding);
 }
 
 static void 
 mqnic_rx_cq_write_tail_ptr(struct mqnic_cq_ring *ring)
 {
+	if (ring->tail_ptr - ring->written_tail_ptr < ring->tail_batch)
+		return;
+
 	MQNIC_DIRECT_WRITE_REG(ring->hw_tail_ptr, 0, ring->tail_ptr & ring->hw_ptr_mask);
+	ring->written_tail_ptr = ring->tail_ptr;
 	PMD_RX_LOG(DEBUG, "update cq ring tail ptr register = %d, ring->tail_ptr = %d", ring->tail_ptr & ring->hw_ptr_mask, ring->tail_ptr);
 }
 
 static void 
 mqnic_tx_cq_write_tail_ptr(struct mqnic_cq_ring *ring)
 {
+	if (ring->tail_ptr - ring->written_tail_ptr < ring->tail_batch)
+		return;
+
 	MQNIC_DIRECT_WRITE_REG(ring->hw_tail_ptr, 0, ring->tail_ptr & ring->hw_ptr_mask);
+	ring->written_tail_ptr = ring->tail_ptr;
 	PMD_TX_LOG(DEBUG, "update cq ring tail ptr register = %d, ring->tail_ptr = %d", ring->tail_ptr & ring->hw_ptr_mask, ring->tail_ptr);
 }
 
-static void 
-mqnic_rx_read_tail_ptr(struct mqnic_rx_queue *rxq)
-{
-    rxq->tail_ptr += (MQNIC_DIRECT_READ_REG(rxq->hw_tail_ptr, 0) - rxq->tail_ptr) & rxq->hw_ptr_mask;
-}
-
 static void 
 mqnic_rx_write_head_ptr(struct mqnic_rx_queue *rxq)
 {
 	MQNIC_DIRECT_WRITE_REG(rxq->hw_head_ptr, 0, rxq->head_ptr & rxq->hw_ptr_mask);
 }
 
-static inline void
-mqnic_check_tx_cpl(struct mqnic_tx_queue *txq)
+/*
+ * Reclaim up to max_cnt transmitted descriptors from the completion
+ * records in host memory. Each record names the ring slot it completes
+ * through cpl->index, so the mbufs of that slot are released directly and
+ * clean_tail_ptr is advanced over released slots without reading the TX
+ * queue tail pointer.
+ * The CQ tail pointer is written back once for the whole batch.
+ *
+ * Released mbufs are gathered and returned to their mempool in bulk. With
+ * DEV_TX_OFFLOAD_MBUF_FAST_FREE they all come from one pool with a
+ * reference count of 1 and skip rte_pktmbuf_prefree_seg(); otherwise each
+ * run of mbufs from the same pool is returned with one call.
+ */
+static uint32_t
+mqnic_tx_reclaim_cnt(struct mqnic_tx_queue *txq, uint32_t max_cnt)
 {
-	struct mqnic_adapter *adapter = txq->adapter;
-	struct mqnic_cq_ring *cq_ring;
-
-	PMD_TX_LOG(DEBUG, "mqnic_check_tx_cpl start");
+	struct mqnic_cq_ring *cq_ring = txq->cq_ring;
+	struct mqnic_tx_entry *sw_ring = txq->sw_ring;
+	const bool fast_free = txq->offloads & DEV_TX_OFFLOAD_MBUF_FAST_FREE;
+	struct rte_mbuf *free[MQNIC_TX_FREE_BULK];
+	struct mqnic_tx_entry *txe;
+	volatile struct mqnic_cpl *cpl;
+	struct rte_mbuf *m;
+	uint32_t cq_tail_ptr;
+	uint32_t ring_clean_tail_ptr;
+	uint32_t ring_index;
+	uint32_t nb_free = 0;
+	uint32_t done = 0;
+	uint32_t i;
 
-	cq_ring = adapter->tx_cpl_ring[txq->queue_id];   //assume queue_id of txq == queue_id of tx_cpl_queue
 	mqnic_cq_read_head_ptr(cq_ring);
 
-	cq_ring->tail_ptr = cq_ring->head_ptr;
-	mqnic_tx_cq_write_tail_ptr(cq_ring);
+	cq_tail_ptr = cq_ring->tail_ptr;
+	while (cq_ring->head_ptr != cq_tail_ptr && done < max_cnt) {
+		cpl = (volatile struct mqnic_cpl *)(cq_ring->buf +
+			(cq_tail_ptr & cq_ring->size_mask) * cq_ring->stride);
+		ring_index = cpl->index & txq->size_mask;
+		txe = &sw_ring[ring_index];
+
+		/* segments fill a slot from its first entry */
+		for (i = 0; i < txq->desc_block_size && txe->mbuf[i] != NULL; i++) {
+			m = txe->mbuf[i];
+			txe->mbuf[i] = NULL;
+
+			if (fast_free) {
+				/* only multi-segment queues see chained mbufs */
+				if (txq->desc_block_size > 1) {
+					m->next = NULL;
+					m->nb_segs = 1;
+				}
+			} else {
+				m = rte_pktmbuf_prefree_seg(m);
+				if (m == NULL)
+					continue;
+			}
+
+			if (nb_free == MQNIC_TX_FREE_BULK ||
+			    (nb_free > 0 && m->pool != free[0]->pool)) {
+				rte_mempool_put_bulk(free[0]->pool, (void **)free, nb_free);
+				nb_free = 0;
+			}
+			free[nb_free++] = m;
+		}
+
+		done++;
+		cq_tail_ptr++;
+	}
+
+	if (nb_free > 0)
+		rte_mempool_put_bulk(free[0]->pool, (void **)free, nb_free);
+
+	if (done) {
+		cq_ring->tail_ptr = cq_tail_ptr;
+		mqnic_tx_cq_write_tail_ptr(cq_ring);
+		// report the next completion to rte_pmd_mqnic_poll_events()
+		if (txq->adapter->event_poll)
+			mqnic_arm_cq(cq_ring);
+	}
 
 	// process ring
-	mqnic_tx_read_tail_ptr(txq);
-	txq->clean_tail_ptr = txq->tail_ptr;
+	ring_clean_tail_ptr = txq->clean_tail_ptr;
+	while (ring_clean_tail_ptr != txq->head_ptr) {
+		if (sw_ring[ring_clean_tail_ptr & txq->size_mask].mbuf[0] != NULL)
+			break;
+		ring_clean_tail_ptr++;
+	}
+	txq->clean_tail_ptr = ring_clean_tail_ptr;
 
-	mqnic_arm_cq(cq_ring);
-	PMD_TX_LOG(DEBUG, "mqnic_check_tx_cpl finish");
+	PMD_TX_LOG(DEBUG, "reclaimed %u completions, clean_tail_ptr = %u",
+		done, txq->clean_tail_ptr);
+	return done;
+}
+
+uint32_t
+mqnic_tx_reclaim(struct mqnic_tx_queue *txq)
+{
+	return mqnic_tx_reclaim_cnt(txq, UINT32_MAX);
+}
+
+/*
+ * Encode the TCP/UDP checksum request of an mbuf as tx_csum_cmd. The
+ * checksum field must hold the pseudo-header sum, see eth_mqnic_prep_pkts().
+ */
+static inline uint16_t
+mqnic_tx_csum_cmd(const struct rte_mbuf *m)
+{
+	uint32_t start, offset;
+
+	switch (m->ol_flags & PKT_TX_L4_MASK) {
+	case PKT_TX_TCP_CKSUM:
+		offset = offsetof(struct rte_tcp_hdr, cksum);
+		break;
+	case PKT_TX_UDP_CKSUM:
+		offset = offsetof(struct rte_udp_hdr, dgram_cksum);
+		break;
+	default:
+		return 0;
+	}
+
+	start = m->l2_len + m->l3_len;
+	if (unlikely(start > MQNIC_TX_CSUM_START_MAX))
+		return 0;
+
+	return rte_cpu_to_le_16(MQNIC_TX_CSUM_CMD_ENABLE |
+				(offset << MQNIC_TX_CSUM_CMD_OFFSET_SHIFT) | start);
 }
 
 uint16_t
@@ -156,13 +281,12 @@ eth_mqnic_xmit_pkts(void *tx_queue, struct rte_mbuf **tx_pkts,
 	uint16_t nb_tx;
 	uint32_t i;
 	uint32_t sub_desc_index;
-	struct mqnic_adapter *adapter;
 
 	txq = tx_queue;
-	adapter = txq->adapter;
 	sw_ring = txq->sw_ring; /* tx_info */
 
-	mqnic_check_tx_cpl(txq);
+	if (mqnic_tx_free_slots(txq) < txq->tx_free_thresh)
+		mqnic_tx_reclaim(txq);
 
 	for (nb_tx = 0; nb_tx < nb_pkts; nb_tx++) {
 		index = txq->head_ptr & txq->size_mask;
@@ -175,8 +299,6 @@ eth_mqnic_xmit_pkts(void *tx_queue, struct rte_mbuf **tx_pkts,
 		txd = (struct mqnic_desc *)(txq->buf + index * txq->stride);
 		tx_pkt = *tx_pkts++;
 
-		RTE_MBUF_PREFETCH_TO_FREE(txe->mbuf[0]);
-
 		//tx_last = (uint16_t) (tx_id + tx_pkt->nb_segs - 1);
 		/*tx_last = (uint16_t) tx_id;*/
 
@@ -192,16 +314,24 @@ eth_mqnic_xmit_pkts(void *tx_queue, struct rte_mbuf **tx_pkts,
 			goto end_of_tx;
 		}
 
+		/* the remaining segments would silently be cut off */
+		if (unlikely(tx_pkt->nb_segs > txq->desc_block_size)) {
+			PMD_TX_LOG(DEBUG, "drop packet of %u segments, block of %u",
+				   (unsigned) tx_pkt->nb_segs,
+				   (unsigned) txq->desc_block_size);
+			rte_pktmbuf_free(tx_pkt);
+			txq->stats.errors++;
+			continue;
+		}
+
+		txd[0].tx_csum_cmd = mqnic_tx_csum_cmd(tx_pkt);
+
 		m_seg = tx_pkt;
 		/*txn = &sw_ring[txe->next_id];*/
 		do {
 			/*txd = &txr[index * txq->stride + sub_desc_index];*/
-			txd += sub_desc_index;
 
-			/*txd->tx_csum_cmd = 0;*/
-
-			if (txe->mbuf[sub_desc_index] != NULL)
-				rte_pktmbuf_free_seg(txe->mbuf[sub_desc_index]);
+			/* slots are emptied by mqnic_tx_reclaim() */
 			txe->mbuf[sub_desc_index] = m_seg;
 
 			/*
@@ -209,15 +339,15 @@ eth_mqnic_xmit_pkts(void *tx_queue, struct rte_mbuf **tx_pkts,
 			 */
 			slen = (uint16_t) m_seg->data_len;
 			buf_dma_addr = rte_mbuf_data_iova(m_seg);
-			txd->addr = rte_cpu_to_le_64(buf_dma_addr);
-			txd->len = rte_cpu_to_le_32(slen);
+			txd[sub_desc_index].addr = rte_cpu_to_le_64(buf_dma_addr);
+			txd[sub_desc_index].len = rte_cpu_to_le_32(slen);
 
 			PMD_TX_LOG(DEBUG, "desc_index=%u data_len=%u dma_addr=%u",
-				   (unsigned) index, (unsigned) txd->len, (unsigned) txd->addr);
+				   (unsigned) index, (unsigned) slen, (unsigned) buf_dma_addr);
 			
 			m_seg = m_seg->next;
 
-			adapter->obytes+=slen;
+			txq->stats.bytes += slen;
 			sub_desc_index++;
 
 			if(sub_desc_index >= txq->desc_block_size)
@@ -233,7 +363,7 @@ eth_mqnic_xmit_pkts(void *tx_queue, struct rte_mbuf **tx_pkts,
 		/*tx_id = txe->next_id;*/
 		/*txe = txn;*/
 		txq->head_ptr++;
-		adapter->opackets++;
+		txq->stats.packets++;
 	}
  end_of_tx:
 	rte_wmb();
@@ -247,47 +377,173 @@ eth_mqnic_xmit_pkts(void *tx_queue, struct rte_mbuf **tx_pkts,
 	return nb_tx;
 }
 
-static int eth_mqnic_prepare_rx_desc(struct mqnic_rx_queue *rxq, int index) {
-	struct mqnic_rx_entry *rxe = &rxq->sw_ring[index];
-	struct rte_mbuf *nmb;
-	uint64_t dma_addr;
-	volatile struct mqnic_desc *rxdp = (struct mqnic_desc *)(rxq->buf + index * rxq->stride);
-
-	nmb = rte_mbuf_raw_alloc(rxq->mb_pool);
-	if (nmb == NULL) {
-		PMD_RX_LOG(ERR, "RX mbuf alloc failed port_id=%u "
-			   "queue_id=%u", (unsigned) rxq->port_id,
-			   (unsigned) rxq->queue_id);
-		rte_eth_devices[rxq->port_id].data->rx_mbuf_alloc_failed++;
-		return -1;
+/*********************************************************************
+ *
+ *  TX prep functions
+ *
+ **********************************************************************/
+uint16_t
+eth_mqnic_prep_pkts(void *tx_queue, struct rte_mbuf **tx_pkts,
+		uint16_t nb_pkts)
+{
+	struct mqnic_tx_queue *txq = tx_queue;
+	struct rte_mbuf *m;
+	uint64_t l4_flags;
+	uint16_t i;
+	int ret;
+
+	for (i = 0; i < nb_pkts; i++) {
+		m = tx_pkts[i];
+		l4_flags = m->ol_flags & PKT_TX_L4_MASK;
+
+		/* one TX block carries at most desc_block_size segments */
+		if (m->nb_segs > txq->desc_block_size) {
+			rte_errno = EINVAL;
+			return i;
+		}
+
+		if ((m->ol_flags & MQNIC_TX_OFFLOAD_NOTSUP_MASK) ||
+		    l4_flags == PKT_TX_SCTP_CKSUM) {
+			rte_errno = ENOTSUP;
+			return i;
+		}
+
+		if (l4_flags != PKT_TX_L4_NO_CKSUM &&
+		    m->l2_len + m->l3_len > MQNIC_TX_CSUM_START_MAX) {
+			rte_errno = EINVAL;
+			return i;
+		}
+
+#ifdef RTE_LIBRTE_ETHDEV_DEBUG
+		ret = rte_validate_tx_offload(m);
+		if (ret != 0) {
+			rte_errno = -ret;
+			return i;
+		}
+#endif
+		ret = rte_net_intel_cksum_prepare(m);
+		if (ret != 0) {
+			rte_errno = -ret;
+			return i;
+		}
 	}
 
-	rxe->mbuf = nmb;
+	return i;
+}
 
-	PMD_RX_LOG(DEBUG, "nmb->buf_len=%u ", (unsigned) nmb->buf_len);
-	rxdp->len = nmb->buf_len;
-	dma_addr = rte_cpu_to_le_64(rte_mbuf_data_iova_default(nmb));
-	rxdp->addr = dma_addr;
+/* Point the descriptors of nb ring slots starting at index at their mbufs. */
+static inline void
+mqnic_rx_post_descs(struct mqnic_rx_queue *rxq, u32 index, u32 nb)
+{
+	volatile struct mqnic_desc *rxdp = &rxq->rx_ring[index * rxq->desc_block_size];
+	struct mqnic_rx_entry *rxe = &rxq->sw_ring[index * rxq->desc_block_size];
+	u32 i;
 
-	return 0;
+	for (i = 0; i < nb * rxq->desc_block_size; i++) {
+		rxdp[i].len = rxq->rx_buf_len;
+		rxdp[i].addr = rte_cpu_to_le_64(rte_mbuf_data_iova_default(rxe[i].mbuf));
+	}
 }
 
+/*
+ * Post buffers for nb ring slots starting at index and return the number
+ * of slots filled. With one descriptor per slot the mbufs are taken in
+ * bulk straight into the software ring. Multi-descriptor slots keep the
+ * segments their last completion did not use, so only their empty
+ * entries are filled, with one bulk request per slot.
+ */
+static u32
+mqnic_rx_alloc_bulk(struct mqnic_rx_queue *rxq, u32 index, u32 nb)
+{
+	const u32 block = rxq->desc_block_size;
+	struct rte_mbuf *mbufs[MQNIC_MAX_FRAGS];
+	struct mqnic_rx_entry *rxe;
+	u32 i, j, k;
+
+	/* the software ring doubles as the mbuf pointer array */
+	RTE_BUILD_BUG_ON(sizeof(struct mqnic_rx_entry) != sizeof(struct rte_mbuf *));
+
+	if (block == 1) {
+		if (rte_mempool_get_bulk(rxq->mb_pool, (void **)&rxq->sw_ring[index], nb) != 0)
+			return 0;
+		mqnic_rx_post_descs(rxq, index, nb);
+		return nb;
+	}
+
+	for (i = 0; i < nb; i++) {
+		rxe = &rxq->sw_ring[(index + i) * block];
+
+		for (j = 0, k = 0; j < block; j++)
+			k += rxe[j].mbuf == NULL;
+		if (k > 0 && rte_mempool_get_bulk(rxq->mb_pool, (void **)mbufs, k) != 0)
+			break;
+
+		for (j = 0; j < block; j++)
+			if (rxe[j].mbuf == NULL)
+				rxe[j].mbuf = mbufs[--k];
+		mqnic_rx_post_descs(rxq, index + i, 1);
+	}
+
+	return i;
+}
+
+/*
+ * Refill the empty ring slots once at least rx_free_thresh of them are
+ * available. Allocation is done in bulk up to the ring wrap; when the bulk
+ * request fails a single rx_free_thresh batch is tried before further
+ * attempts are backed off for an exponentially growing number of polls.
+ */
 static void eth_mqnic_refill_rx_buffers(struct mqnic_rx_queue *rxq) {
 	u32 missing = rxq->size - (rxq->head_ptr - rxq->clean_tail_ptr);
+	u32 filled = 0;
+	u32 index;
+	u32 done;
+	u32 n;
+
+	if (missing < rxq->rx_free_thresh)
+		return;
 
-	if (missing < 8)
+	if (rxq->refill_skip > 0) {
+		rxq->refill_skip--;
 		return;
+	}
+
+	while (missing >= rxq->rx_free_thresh) {
+		index = rxq->head_ptr & rxq->size_mask;
+		n = RTE_MIN(missing, rxq->size - index);
 
-	for (; missing-- > 0;) {
-		if (eth_mqnic_prepare_rx_desc(rxq, rxq->head_ptr & rxq->size_mask))
+		done = mqnic_rx_alloc_bulk(rxq, index, n);
+		if (done == 0 && n > rxq->rx_free_thresh) {
+			n = rxq->rx_free_thresh;
+			done = mqnic_rx_alloc_bulk(rxq, index, n);
+		}
+
+		rxq->head_ptr += done;
+		missing -= done;
+		filled += done;
+
+		if (done < n) {
+			PMD_RX_LOG(ERR, "RX mbuf alloc failed port_id=%u "
+				   "queue_id=%u", (unsigned) rxq->port_id,
+				   (unsigned) rxq->queue_id);
+			rte_eth_devices[rxq->port_id].data->rx_mbuf_alloc_failed += n - done;
+			rxq->refill_backoff = RTE_MIN(
+				rxq->refill_backoff ? rxq->refill_backoff << 1 : 1,
+				MQNIC_RX_REFILL_BACKOFF_MAX);
+			rxq->refill_skip = rxq->refill_backoff;
 			break;
-		rxq->head_ptr++;
+		}
 	}
 
+	if (filled == 0)
+		return;
+
+	if (missing < rxq->rx_free_thresh)
+		rxq->refill_backoff = 0;
+
 	// enqueue on NIC
 	mqnic_rx_write_head_ptr(rxq);
 	MQNIC_WRITE_FLUSH(rxq);
-	return;
 }
 
 /*********************************************************************
@@ -295,6 +551,146 @@ static void eth_mqnic_refill_rx_buffers(struct mqnic_rx_queue *rxq) {
  *  RX functions
  *
  **********************************************************************/
+static inline uint16_t
+mqnic_csum_add(uint16_t sum, uint16_t val)
+{
+	uint32_t s = (uint32_t)sum + val;
+
+	return (uint16_t)((s & 0xffff) + (s >> 16));
+}
+
+static inline uint16_t
+mqnic_csum_sub(uint16_t sum, uint16_t val)
+{
+	return mqnic_csum_add(sum, (uint16_t)~val);
+}
+
+/*
+ * Turn cpl->rx_csum, the ones' complement sum of the frame following the
+ * Ethernet header, into checksum flags. The VLAN tag, the IP header and
+ * any padding after the IP datagram are taken out of the sum and the
+ * pseudo header is added in; a valid TCP or UDP checksum then folds to
+ * 0xffff. The IPv4 header checksum is verified on the way.
+ */
+static uint64_t
+mqnic_rx_csum_flags(const struct rte_mbuf *rxm, uint16_t rx_csum)
+{
+	const uint8_t *pkt = rte_pktmbuf_mtod(rxm, const uint8_t *);
+	const uint32_t len = rxm->data_len;
+	const uint32_t pkt_len = rxm->pkt_len;
+	uint16_t sum = rte_cpu_to_be_16(rte_le_to_cpu_16(rx_csum));
+	uint64_t ip_flags = PKT_RX_IP_CKSUM_UNKNOWN;
+	uint32_t off = sizeof(struct rte_ether_hdr);
+	uint32_t l3_len, end;
+	uint16_t ether_type, pad;
+	uint8_t proto;
+
+	if (len < off)
+		return PKT_RX_IP_CKSUM_UNKNOWN | PKT_RX_L4_CKSUM_UNKNOWN;
+
+	ether_type = ((const struct rte_ether_hdr *)pkt)->ether_type;
+	if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN)) {
+		const struct rte_vlan_hdr *vh = (const struct rte_vlan_hdr *)(pkt + off);
+
+		if (len < off + sizeof(*vh))
+			return PKT_RX_IP_CKSUM_UNKNOWN | PKT_RX_L4_CKSUM_UNKNOWN;
+		sum = mqnic_csum_sub(sum, rte_raw_cksum(vh, sizeof(*vh)));
+		ether_type = vh->eth_proto;
+		off += sizeof(*vh);
+	}
+
+	if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4)) {
+		const struct rte_ipv4_hdr *ip = (const struct rte_ipv4_hdr *)(pkt + off);
+		uint16_t ip_sum;
+
+		if (len < off + sizeof(*ip))
+			return PKT_RX_IP_CKSUM_UNKNOWN | PKT_RX_L4_CKSUM_UNKNOWN;
+
+		l3_len = (ip->version_ihl & RTE_IPV4_HDR_IHL_MASK) * RTE_IPV4_IHL_MULTIPLIER;
+		end = off + rte_be_to_cpu_16(ip->total_length);
+		if (l3_len < sizeof(*ip) || end < off + l3_len || end > pkt_len)
+			return PKT_RX_IP_CKSUM_BAD | PKT_RX_L4_CKSUM_UNKNOWN;
+		if (off + l3_len > len)
+			return PKT_RX_IP_CKSUM_UNKNOWN | PKT_RX_L4_CKSUM_UNKNOWN;
+
+		ip_sum = rte_raw_cksum(ip, l3_len);
+		if (ip_sum != 0xffff)
+			return PKT_RX_IP_CKSUM_BAD | PKT_RX_L4_CKSUM_UNKNOWN;
+		ip_flags = PKT_RX_IP_CKSUM_GOOD;
+
+		/* fragments cannot be checked */
+		if (ip->fragment_offset & rte_cpu_to_be_16(RTE_IPV4_HDR_MF_FLAG |
+							   RTE_IPV4_HDR_OFFSET_MASK))
+			return ip_flags | PKT_RX_L4_CKSUM_UNKNOWN;
+
+		sum = mqnic_csum_sub(sum, ip_sum);
+		sum = mqnic_csum_add(sum, rte_ipv4_phdr_cksum(ip, 0));
+		proto = ip->next_proto_id;
+	} else if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV6)) {
+		const struct rte_ipv6_hdr *ip6 = (const struct rte_ipv6_hdr *)(pkt + off);
+
+		l3_len = sizeof(*ip6);
+		if (len < off + l3_len)
+			return PKT_RX_IP_CKSUM_UNKNOWN | PKT_RX_L4_CKSUM_UNKNOWN;
+
+		end = off + l3_len + rte_be_to_cpu_16(ip6->payload_len);
+		if (end > pkt_len)
+			return PKT_RX_IP_CKSUM_UNKNOWN | PKT_RX_L4_CKSUM_UNKNOWN;
+
+		sum = mqnic_csum_sub(sum, rte_raw_cksum(ip6, l3_len));
+		sum = mqnic_csum_add(sum, rte_ipv6_phdr_cksum(ip6, 0));
+		proto = ip6->proto;
+	} else {
+		return PKT_RX_IP_CKSUM_UNKNOWN | PKT_RX_L4_CKSUM_UNKNOWN;
+	}
+
+	if (proto == IPPROTO_UDP) {
+		const struct rte_udp_hdr *udp = (const struct rte_udp_hdr *)(pkt + off + l3_len);
+
+		if (end < off + l3_len + sizeof(*udp))
+			return ip_flags | PKT_RX_L4_CKSUM_BAD;
+		if (len < off + l3_len + sizeof(*udp))
+			return ip_flags | PKT_RX_L4_CKSUM_UNKNOWN;
+		/* UDP over IPv4 may omit the checksum */
+		if (udp->dgram_cksum == 0 && ip_flags == PKT_RX_IP_CKSUM_GOOD)
+			return ip_flags | PKT_RX_L4_CKSUM_UNKNOWN;
+	} else if (proto != IPPROTO_TCP) {
+		return ip_flags | PKT_RX_L4_CKSUM_UNKNOWN;
+	}
+
+	/* padding after the datagram is covered by the hardware sum */
+	if (end < pkt_len) {
+		if (rte_raw_cksum_mbuf(rxm, end, pkt_len - end, &pad) != 0)
+			return ip_flags | PKT_RX_L4_CKSUM_UNKNOWN;
+		if ((end - sizeof(struct rte_ether_hdr)) & 1)
+			pad = (uint16_t)((pad << 8) | (pad >> 8));
+		sum = mqnic_csum_sub(sum, pad);
+	}
+
+	return ip_flags | (sum == 0xffff ? PKT_RX_L4_CKSUM_GOOD : PKT_RX_L4_CKSUM_BAD);
+}
+
+/*
+ * Fill the hardware offload results of a completion record into the mbuf
+ * and return its ol_flags.
+ */
+static __rte_always_inline uint64_t
+mqnic_rx_offload(const struct mqnic_rx_queue *rxq,
+		volatile struct mqnic_cpl *cpl, struct rte_mbuf *rxm)
+{
+	uint64_t pkt_flags = 0;
+
+	if (rxq->flags & MQNIC_RXQ_FLAG_RX_HASH) {
+		rxm->hash.rss = rte_le_to_cpu_32(cpl->rx_hash);
+		pkt_flags |= PKT_RX_RSS_HASH;
+	}
+
+	if (rxq->flags & MQNIC_RXQ_FLAG_RX_CSUM)
+		pkt_flags |= mqnic_rx_csum_flags(rxm, cpl->rx_csum);
+
+	return pkt_flags;
+}
+
 uint16_t
 eth_mqnic_recv_pkts(void *rx_queue, struct rte_mbuf **rx_pkts,
 	       uint16_t nb_pkts)
@@ -308,7 +704,6 @@ eth_mqnic_recv_pkts(void *rx_queue, struct rte_mbuf **rx_pkts,
 	uint32_t cq_index;
 	uint32_t cq_tail_ptr;
 	uint32_t cq_desc_inline_index;
-	uint32_t ring_clean_tail_ptr;
 	volatile struct mqnic_cpl *cpl;
 	struct mqnic_cq_ring *cq_ring;
 	struct mqnic_adapter *adapter;
@@ -319,7 +714,7 @@ eth_mqnic_recv_pkts(void *rx_queue, struct rte_mbuf **rx_pkts,
 	budget = rxq->full_size;
 	adapter = rxq->adapter;
 	cq_ring = adapter->rx_cpl_ring[rxq->cpl_index];
-	mqnic_cq_read_head_ptr(cq_ring);
+	mqnic_rx_cq_poll_head_ptr(cq_ring, RTE_MIN((uint32_t)nb_pkts, rxq->full_size));
 
 	cq_tail_ptr = cq_ring->tail_ptr;
 	cq_index = cq_tail_ptr & cq_ring->size_mask;
@@ -375,6 +770,7 @@ eth_mqnic_recv_pkts(void *rx_queue, struct rte_mbuf **rx_pkts,
 		rxm->pkt_len = pkt_len;
 		rxm->data_len = pkt_len;
 		rxm->port = rxq->port_id;
+		rxm->ol_flags = mqnic_rx_offload(rxq, cpl, rxm);
 
 		rxe->mbuf = NULL;
 		/*
@@ -387,24 +783,45 @@ eth_mqnic_recv_pkts(void *rx_queue, struct rte_mbuf **rx_pkts,
 		cq_tail_ptr++;
 		cq_index = cq_tail_ptr & cq_ring->size_mask;
 
-		adapter->ipackets++;
-		adapter->ibytes+=pkt_len;
+		rxq->stats.packets++;
+		rxq->stats.bytes += pkt_len;
 	}
 	/*rxq->rx_tail = rx_id;*/
 
 	// update CQ tail
 	cq_ring->tail_ptr = cq_tail_ptr;
-	mqnic_rx_cq_write_tail_ptr(cq_ring);
+	mqnic_rx_complete(rxq, cq_ring);
 
+	return nb_rx;
+}
+
+/*
+ * Return the completions consumed by an RX burst to the NIC: write the CQ
+ * tail pointer, advance clean_tail_ptr over the slots handed to the
+ * application, refill them and re-arm the CQ. Shared by the scalar and
+ * vector RX bursts.
+ *
+ * The slots to reclaim are known from the completions alone: a burst takes
+ * the mbufs of the slot each completion names, so clean_tail_ptr advances
+ * over the slots whose first entry is empty, up to the first slot the NIC
+ * has not completed yet. The queue tail pointer register is not read.
+ */
+void
+mqnic_rx_complete(struct mqnic_rx_queue *rxq, struct mqnic_cq_ring *cq_ring)
+{
+	u32 ring_clean_tail_ptr;
 	u32 ring_index;
 	struct mqnic_rx_entry *rx_info;
-	mqnic_rx_read_tail_ptr(rxq);
+
+	mqnic_rx_cq_clear(cq_ring);
+	mqnic_rx_cq_write_tail_ptr(cq_ring);
+
 	ring_clean_tail_ptr = rxq->clean_tail_ptr;
 
-	while (ring_clean_tail_ptr != rxq->tail_ptr)
+	while (ring_clean_tail_ptr != rxq->head_ptr)
 	{
 		ring_index = ring_clean_tail_ptr & rxq->size_mask;
-		rx_info = &rxq->sw_ring[ring_index];
+		rx_info = &rxq->sw_ring[ring_index * rxq->desc_block_size];
 		if (rx_info->mbuf)
 			break;
 
@@ -415,21 +832,101 @@ eth_mqnic_recv_pkts(void *rx_queue, struct rte_mbuf **rx_pkts,
 	rxq->clean_tail_ptr = ring_clean_tail_ptr;
 	eth_mqnic_refill_rx_buffers(rxq);
 
-	mqnic_arm_cq(cq_ring);
-
-	return nb_rx;
+	// report the next completion to rte_pmd_mqnic_poll_events(); RX
+	// interrupt mode arms in rx_queue_intr_enable, pure polling never
+	if (rxq->flags & MQNIC_RXQ_FLAG_ARM_CQ)
+		mqnic_arm_cq(cq_ring);
 }
 
+/*
+ * Receive packets spread over the descriptors of multi-descriptor RX
+ * blocks. A completion always describes a whole frame, so the segments of
+ * one block are chained right away and no partial packet is carried over
+ * to the next burst. Segments a frame does not need stay in the ring for
+ * the next refill.
+ */
 uint16_t
 eth_mqnic_recv_scattered_pkts(void *rx_queue, struct rte_mbuf **rx_pkts,
 			 uint16_t nb_pkts)
 {
-	RTE_SET_USED(rx_queue);
-	RTE_SET_USED(rx_pkts);
-	RTE_SET_USED(nb_pkts);
-	PMD_RX_LOG(ERR, "eth_mqnic_recv_scattered_pkts is not supported");
-	return 0;
+	struct mqnic_rx_queue *rxq = rx_queue;
+	struct mqnic_adapter *adapter = rxq->adapter;
+	struct mqnic_cq_ring *cq_ring = adapter->rx_cpl_ring[rxq->cpl_index];
+	const u32 block = rxq->desc_block_size;
+	volatile struct mqnic_cpl *cpl;
+	struct mqnic_rx_entry *rxe;
+	struct rte_mbuf *first_seg;
+	struct rte_mbuf *last_seg;
+	struct rte_mbuf *rxm;
+	uint32_t cq_tail_ptr;
+	uint32_t remaining;
+	uint16_t pkt_len;
+	uint16_t nb_rx = 0;
+	u32 budget = rxq->full_size;
+	u32 seg;
 
+	mqnic_rx_cq_poll_head_ptr(cq_ring, RTE_MIN((uint32_t)nb_pkts, budget));
+	cq_tail_ptr = cq_ring->tail_ptr;
+
+	while (nb_rx < nb_pkts && cq_ring->head_ptr != cq_tail_ptr && nb_rx < budget) {
+		cpl = (volatile struct mqnic_cpl *)(cq_ring->buf +
+			(cq_tail_ptr & cq_ring->size_mask) * cq_ring->stride);
+		rxe = &rxq->sw_ring[(cpl->index & rxq->size_mask) * block];
+		pkt_len = cpl->len;
+
+		PMD_RX_LOG(DEBUG, "port_id=%u queue_id=%u index=%u pkt_len=%u",
+			   (unsigned) rxq->port_id, (unsigned) rxq->queue_id,
+			   (unsigned) cpl->index, (unsigned) pkt_len);
+
+		first_seg = NULL;
+		last_seg = NULL;
+		remaining = pkt_len;
+		seg = 0;
+		do {
+			rxm = rxe[seg].mbuf;
+			rxe[seg].mbuf = NULL;
+
+			rxm->data_off = RTE_PKTMBUF_HEADROOM;
+			rxm->data_len = (uint16_t)RTE_MIN(remaining, rxq->rx_buf_len);
+			rxm->next = NULL;
+			remaining -= rxm->data_len;
+
+			if (first_seg == NULL)
+				first_seg = rxm;
+			else
+				last_seg->next = rxm;
+			last_seg = rxm;
+			seg++;
+		} while (remaining > 0 && seg < block);
+
+		cq_tail_ptr++;
+
+		/* a frame longer than the block would be delivered truncated */
+		if (unlikely(remaining > 0)) {
+			PMD_RX_LOG(DEBUG, "drop frame of %u bytes, %u bytes posted",
+				   (unsigned) pkt_len, block * rxq->rx_buf_len);
+			rte_pktmbuf_free(first_seg);
+			rxq->stats.errors++;
+			continue;
+		}
+
+		first_seg->nb_segs = seg;
+		first_seg->pkt_len = pkt_len;
+		first_seg->port = rxq->port_id;
+		first_seg->ol_flags = mqnic_rx_offload(rxq, cpl, first_seg);
+
+		rte_packet_prefetch((char *)first_seg->buf_addr + first_seg->data_off);
+		rx_pkts[nb_rx++] = first_seg;
+
+		rxq->stats.packets++;
+		rxq->stats.bytes += first_seg->pkt_len;
+	}
+
+	// update CQ tail
+	cq_ring->tail_ptr = cq_tail_ptr;
+	mqnic_rx_complete(rxq, cq_ring);
+
+	return nb_rx;
 }
 
 
@@ -464,6 +961,9 @@ mqnic_tx_queue_release(struct mqnic_tx_queue *txq)
 {
 	if (txq != NULL) {
 		mqnic_tx_queue_release_mbufs(txq);
+		if (txq->cq_ring != NULL)
+			mqnic_cpl_queue_free(txq->adapter->dev, true,
+					     txq->cq_ring->index);
 		rte_free(txq->sw_ring);
 		rte_free(txq);
 	}
@@ -475,123 +975,21 @@ eth_mqnic_tx_queue_release(void *txq)
 	mqnic_tx_queue_release(txq);
 }
 
+/*
+ * Free the mbufs of up to free_cnt transmitted packets, of all of them if
+ * free_cnt is 0, and return how many were freed. Only slots the NIC has
+ * written a completion for are released, so no mbuf still being read by
+ * DMA is freed, and clean_tail_ptr moves over them for the next burst.
+ */
 static int
 mqnic_tx_done_cleanup(struct mqnic_tx_queue *txq, uint32_t free_cnt)
 {
-	struct mqnic_tx_entry *sw_ring;
-	uint16_t tx_first; /* First segment analyzed. */
-	uint16_t tx_id;    /* Current segment being processed. */
-	uint16_t tx_last;  /* Last segment in the current packet. */
-	uint16_t tx_next;  /* First segment of the next packet. */
-	int count = 0;
-	int i = 0;
 	PMD_TX_LOG(DEBUG, "mqnic_tx_done_cleanup");
 
 	if (!txq)
 		return -ENODEV;
 
-	sw_ring = txq->sw_ring;
-
-	/* tx_tail is the last sent packet on the sw_ring. Goto the end
-	 * of that packet (the last segment in the packet chain) and
-	 * then the next segment will be the start of the oldest segment
-	 * in the sw_ring. This is the first packet that will be
-	 * attempted to be freed.
-	 */
-
-	/* Get last segment in most recently added packet. */
-	tx_first = sw_ring[txq->tx_tail].last_id;
-
-	/* Get the next segment, which is the oldest segment in ring. */
-	tx_first = sw_ring[tx_first].next_id;
-
-	/* Set the current index to the first. */
-	tx_id = tx_first;
-
-	/* Loop through each packet. For each packet, verify that an
-	 * mbuf exists and that the last segment is free. If so, free
-	 * it and move on.
-	 */
-	mqnic_check_tx_cpl(txq);
-	while (1) {
-		tx_last = sw_ring[tx_id].last_id;
-
-		if (sw_ring[tx_last].mbuf[0]) {
-			//if (txr[tx_last].wb.status &
-			//    MQNIC_TXD_STAT_DD) {
-			if(1){
-				/* Increment the number of packets
-				 * freed.
-				 */
-				count++;
-
-				/* Get the start of the next packet. */
-				tx_next = sw_ring[tx_last].next_id;
-
-				/* Loop through all segments in a
-				 * packet.
-				 */
-				do {
-					for(i = 0; i < DESC_BLOCK_SIZE; i++){
-						if (sw_ring[tx_id].mbuf[i]) {
-							rte_pktmbuf_free_seg(
-								sw_ring[tx_id].mbuf[i]);
-							sw_ring[tx_id].mbuf[i] = NULL;
-							if(i == 0)
-								sw_ring[tx_id].last_id = tx_id;
-						}
-					}
-
-					/* Move to next segemnt. */
-					tx_id = sw_ring[tx_id].next_id;
-
-				} while (tx_id != tx_next);
-
-				if (unlikely(count == (int)free_cnt))
-					break;
-			} else {
-				/* mbuf still in use, nothing left to
-				 * free.
-				 */
-				break;
-			}
-		} else {
-			/* There are multiple reasons to be here:
-			 * 1) All the packets on the ring have been
-			 *    freed - tx_id is equal to tx_first
-			 *    and some packets have been freed.
-			 *    - Done, exit
-			 * 2) Interfaces has not sent a rings worth of
-			 *    packets yet, so the segment after tail is
-			 *    still empty. Or a previous call to this
-			 *    function freed some of the segments but
-			 *    not all so there is a hole in the list.
-			 *    Hopefully this is a rare case.
-			 *    - Walk the list and find the next mbuf. If
-			 *      there isn't one, then done.
-			 */
-			if (likely(tx_id == tx_first && count != 0))
-				break;
-
-			/* Walk the list and find the next mbuf, if any. */
-			do {
-				/* Move to next segemnt. */
-				tx_id = sw_ring[tx_id].next_id;
-
-				if (sw_ring[tx_id].mbuf[0])
-					break;
-
-			} while (tx_id != tx_first);
-
-			/* Determine why previous loop bailed. If there
-			 * is not an mbuf, done.
-			 */
-			if (!sw_ring[tx_id].mbuf[0])
-				break;
-		}
-	}
-
-	return count;
+	return (int)mqnic_tx_reclaim_cnt(txq, free_cnt ? free_cnt : UINT32_MAX);
 }
 
 int
@@ -616,23 +1014,19 @@ mqnic_reset_tx_queue(struct mqnic_tx_queue *txq, struct rte_eth_dev *dev)
 {
 	static const struct mqnic_desc zeroed_desc = {0, 0, 0, 0};
 	struct mqnic_tx_entry *txe = txq->sw_ring;
-	uint16_t i, j, prev;
+	uint32_t i, j;
 	RTE_SET_USED(dev);
 
 	/* Zero out HW ring memory */
-	for (i = 0; i < txq->nb_tx_desc*DESC_BLOCK_SIZE; i++) {
+	for (i = 0; i < txq->nb_tx_desc * txq->desc_block_size; i++) {
 		txq->tx_ring[i] = zeroed_desc;
 	}
 
 	/* Initialize ring entries */
-	prev = (uint16_t)(txq->nb_tx_desc - 1);
 	for (i = 0; i < txq->nb_tx_desc; i++) {
 		for(j = 0; j < DESC_BLOCK_SIZE; j++){
 			txe[i].mbuf[j] = NULL;
 		}
-		txe[i].last_id = i;
-		txe[prev].next_id = i;
-		prev = i;
 	}
 
 	mqnic_reset_tx_queue_stat(txq);
@@ -641,9 +1035,15 @@ mqnic_reset_tx_queue(struct mqnic_tx_queue *txq, struct rte_eth_dev *dev)
 uint64_t
 mqnic_get_tx_port_offloads_capa(struct rte_eth_dev *dev)
 {
-	uint64_t tx_offload_capa = 0;
-
-	RTE_SET_USED(dev);
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	uint64_t tx_offload_capa;
+
+	/* chained mbufs are only handled by the scalar path */
+	tx_offload_capa = DEV_TX_OFFLOAD_MULTI_SEGS |
+			  DEV_TX_OFFLOAD_MBUF_FAST_FREE;
+	if (adapter->if_features & MQNIC_IF_FEATURE_TX_CSUM)
+		tx_offload_capa |= DEV_TX_OFFLOAD_UDP_CKSUM |
+				   DEV_TX_OFFLOAD_TCP_CKSUM;
 #if 0
 	tx_offload_capa = DEV_TX_OFFLOAD_VLAN_INSERT |
 			  DEV_TX_OFFLOAD_IPV4_CKSUM  |
@@ -666,6 +1066,42 @@ mqnic_get_tx_queue_offloads_capa(struct rte_eth_dev *dev)
 	return tx_queue_offload_capa;
 }
 
+/*
+ * Resolve the socket the rings of a queue are allocated on, following the
+ * device when the application leaves the choice to the driver. Rings,
+ * device and the lcore polling the queue should share a node, as every
+ * burst polls the completion ring. The polling lcore is not known at setup,
+ * so only a node without any enabled lcore is reported.
+ */
+static unsigned int
+mqnic_queue_socket(struct rte_eth_dev *dev, const char *dir,
+		   uint16_t queue_idx, unsigned int socket_id)
+{
+	int dev_node = dev->data->numa_node;
+	unsigned int lcore_id;
+
+	if (socket_id == (unsigned int)SOCKET_ID_ANY)
+		socket_id = dev_node >= 0 ? (unsigned int)dev_node : rte_socket_id();
+
+	if (dev_node >= 0 && socket_id != (unsigned int)dev_node)
+		PMD_INIT_LOG(WARNING, "port %u %s queue %u: rings on socket %u, "
+			     "device on socket %d", dev->data->port_id, dir,
+			     queue_idx, socket_id, dev_node);
+
+	if (socket_id == (unsigned int)SOCKET_ID_ANY)
+		return socket_id;
+
+	RTE_LCORE_FOREACH(lcore_id) {
+		if (rte_lcore_to_socket_id(lcore_id) == socket_id)
+			return socket_id;
+	}
+	PMD_INIT_LOG(WARNING, "port %u %s queue %u: rings on socket %u, "
+		     "no enabled lcore on that socket", dev->data->port_id, dir,
+		     queue_idx, socket_id);
+
+	return socket_id;
+}
+
 int
 eth_mqnic_tx_queue_setup(struct rte_eth_dev *dev,
 			 uint16_t queue_idx,
@@ -676,11 +1112,24 @@ eth_mqnic_tx_queue_setup(struct rte_eth_dev *dev,
 	const struct rte_memzone *tz;
 	struct mqnic_tx_queue *txq;
 	uint64_t offloads;
+	uint32_t cq_size;
+	size_t ring_bytes;
 	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
 	struct mqnic_if *interface = adapter->interface;
-	int desc_block_size = interface->max_desc_block_size < 4 ? interface->max_desc_block_size : 4;
+	int desc_block_size;
 
 	offloads = tx_conf->offloads | dev->data->dev_conf.txmode.offloads;
+	socket_id = mqnic_queue_socket(dev, "tx", queue_idx, socket_id);
+
+	/*
+	 * The NIC fetches a whole descriptor block per packet. Queues that
+	 * only send single-segment packets use one descriptor per block, so
+	 * fetches and ring memory are no larger than needed.
+	 */
+	if (offloads & DEV_TX_OFFLOAD_MULTI_SEGS)
+		desc_block_size = interface->max_desc_block_size < 4 ? interface->max_desc_block_size : 4;
+	else
+		desc_block_size = 1;
 
 	/*
 	 * Validate number of transmit descriptors.
@@ -702,15 +1151,17 @@ eth_mqnic_tx_queue_setup(struct rte_eth_dev *dev,
 	}
 
 	/* First allocate the tx queue data structure */
-	txq = rte_zmalloc("ethdev TX queue", sizeof(struct mqnic_tx_queue),
-							RTE_CACHE_LINE_SIZE);
+	txq = rte_zmalloc_socket("ethdev TX queue", sizeof(struct mqnic_tx_queue),
+				 RTE_CACHE_LINE_SIZE, socket_id);
 	if (txq == NULL)
 		return -ENOMEM;
 
 	txq->adapter = adapter;
 
 	txq->size = roundup_pow_of_two(nb_desc);
-	txq->full_size = txq->size >> 1;
+	txq->full_size = (uint32_t)((uint64_t)txq->size * adapter->tx_fill_pct / 100);
+	if (txq->full_size < MQNIC_MIN_TX_FULL_SIZE)
+		txq->full_size = MQNIC_MIN_TX_FULL_SIZE;
 	txq->size_mask = txq->size-1;
 	txq->stride = roundup_pow_of_two(MQNIC_DESC_SIZE * desc_block_size);
 
@@ -720,13 +1171,36 @@ eth_mqnic_tx_queue_setup(struct rte_eth_dev *dev,
 
 	txq->buf_size = txq->size * txq->stride;
 
+	/* the default is clamped so that the smallest rings remain usable */
+	txq->tx_free_thresh = tx_conf->tx_free_thresh ? tx_conf->tx_free_thresh :
+		RTE_MAX(RTE_MIN(MQNIC_DEFAULT_TX_FREE_THRESH, txq->full_size / 2), 1U);
+	if (txq->tx_free_thresh >= txq->full_size) {
+		PMD_INIT_LOG(ERR, "tx_free_thresh(%u) must be less than %u.",
+			txq->tx_free_thresh, txq->full_size);
+		mqnic_tx_queue_release(txq);
+		return -EINVAL;
+	}
+
+	/* one completion per descriptor block may be outstanding */
+	cq_size = adapter->tx_cq_size ? adapter->tx_cq_size :
+		mqnic_default_cq_size(adapter, txq->size, txq->full_size,
+				      adapter->event_poll);
+	if (cq_size < txq->size) {
+		PMD_INIT_LOG(ERR, "tx_cq_size(%u) must be at least the ring size %u.",
+			     cq_size, txq->size);
+		mqnic_tx_queue_release(txq);
+		return -EINVAL;
+	}
+
 	/*
-	 * Allocate TX ring hardware descriptors. A memzone large enough to
-	 * handle the maximum ring size is allocated in order to allow for
-	 * resizing in later calls to the queue setup function.
+	 * Allocate the ring memory of the queue, TX descriptors followed by
+	 * the completion ring. The memory of an earlier setup of this queue
+	 * is reused when it is large enough.
 	 */
-	tz = rte_eth_dma_zone_reserve(dev, "tx_ring", queue_idx, txq->buf_size,
-				      MQNIC_ALIGN, socket_id);
+	ring_bytes = RTE_ALIGN_CEIL(txq->buf_size, MQNIC_ALIGN);
+	tz = mqnic_ring_mem_reserve(dev, &adapter->tx_ring_mem[queue_idx],
+				    MQNIC_RING_MEM_TX, queue_idx,
+				    ring_bytes + mqnic_cpl_ring_bytes(cq_size), socket_id);
 	if (tz == NULL) {
 		mqnic_tx_queue_release(txq);
 		return -ENOMEM;
@@ -740,9 +1214,19 @@ eth_mqnic_tx_queue_setup(struct rte_eth_dev *dev,
 	txq->tx_ring = (struct mqnic_desc *) tz->addr;
 	txq->buf = (uint8_t *)tz->addr; /* Used to replace tx_ring */
 
-	txq->sw_ring = rte_zmalloc("txq->sw_ring",
+	if (mqnic_cpl_queue_setup(dev, true, queue_idx, cq_size,
+				  (u8 *)tz->addr + ring_bytes, tz->iova + ring_bytes,
+				  socket_id)) {
+		PMD_INIT_LOG(ERR, "failed to size tx cpl queue %u", queue_idx);
+		mqnic_cpl_queue_free(dev, true, queue_idx);
+		mqnic_tx_queue_release(txq);
+		return -ENOMEM;
+	}
+	txq->cq_ring = adapter->tx_cpl_ring[queue_idx];
+
+	txq->sw_ring = rte_zmalloc_socket("txq->sw_ring",
 				   sizeof(struct mqnic_tx_entry) * txq->nb_tx_desc,
-				   RTE_CACHE_LINE_SIZE);
+				   RTE_CACHE_LINE_SIZE, socket_id);
 	if (txq->sw_ring == NULL) {
 		PMD_INIT_LOG(ERR, "failed to alloc sw_ring");
 		mqnic_tx_queue_release(txq);
@@ -750,6 +1234,8 @@ eth_mqnic_tx_queue_setup(struct rte_eth_dev *dev,
 	}
 	PMD_INIT_LOG(DEBUG, "tx index=%d sw_ring=%p hw_ring=%p dma_addr=0x%"PRIx64,
 		     queue_idx, txq->sw_ring, txq->tx_ring, txq->tx_ring_phys_addr);
+	PMD_INIT_LOG(DEBUG, "tx index=%d desc_block_size=%u stride=%u",
+		     queue_idx, txq->desc_block_size, txq->stride);
 
 	txq->hw_addr = interface->hw_addr + interface->tx_queue_offset + queue_idx * interface->tx_queue_stride;
 	txq->hw_ptr_mask = 0xffff;
@@ -773,7 +1259,7 @@ mqnic_rx_queue_release_mbufs(struct mqnic_rx_queue *rxq)
 	unsigned i;
 
 	if (rxq->sw_ring != NULL) {
-		for (i = 0; i < rxq->nb_rx_desc; i++) {
+		for (i = 0; i < rxq->nb_rx_desc * rxq->desc_block_size; i++) {
 			if (rxq->sw_ring[i].mbuf != NULL) {
 				rte_pktmbuf_free_seg(rxq->sw_ring[i].mbuf);
 				rxq->sw_ring[i].mbuf = NULL;
@@ -787,6 +1273,9 @@ mqnic_rx_queue_release(struct mqnic_rx_queue *rxq)
 {
 	if (rxq != NULL) {
 		mqnic_rx_queue_release_mbufs(rxq);
+		if (rxq->cq_ring != NULL)
+			mqnic_cpl_queue_free(rxq->adapter->dev, false,
+					     rxq->cq_ring->index);
 		rte_free(rxq->sw_ring);
 		rte_free(rxq);
 	}
@@ -806,7 +1295,7 @@ mqnic_reset_rx_queue(struct mqnic_rx_queue *rxq)
 	unsigned i;
 
 	/* Zero out HW ring memory */
-	for (i = 0; i < rxq->nb_rx_desc; i++) {
+	for (i = 0; i < rxq->nb_rx_desc * rxq->desc_block_size; i++) {
 		rxq->rx_ring[i] = zeroed_desc;
 	}
 
@@ -817,13 +1306,46 @@ mqnic_reset_rx_queue(struct mqnic_rx_queue *rxq)
 	rxq->head_ptr = 0;
 	rxq->tail_ptr = 0;
 	rxq->clean_tail_ptr = 0;
+	rxq->refill_backoff = 0;
+	rxq->refill_skip = 0;
+}
+
+/*
+ * Precompute the rearm_data of a freshly received single-segment mbuf so
+ * the vector RX path can initialise data_off, refcnt, nb_segs and port
+ * with one 64-bit store.
+ */
+static void
+mqnic_rxq_vec_setup(struct mqnic_rx_queue *rxq)
+{
+	struct rte_mbuf mb_def = { .buf_addr = 0 }; /* zeroed mbuf */
+	uintptr_t p;
+
+	mb_def.nb_segs = 1;
+	mb_def.data_off = RTE_PKTMBUF_HEADROOM;
+	mb_def.port = rxq->port_id;
+	rte_mbuf_refcnt_set(&mb_def, 1);
+
+	/* prevent compiler reordering: rearm_data covers previous fields */
+	rte_compiler_barrier();
+	p = (uintptr_t)&mb_def.rearm_data;
+	rxq->mbuf_initializer = *(uint64_t *)p;
 }
 
 uint64_t
 mqnic_get_rx_port_offloads_capa(struct rte_eth_dev *dev)
 {
-	uint64_t rx_offload_capa = 0;
-	RTE_SET_USED(dev);
+	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
+	uint64_t rx_offload_capa = DEV_RX_OFFLOAD_JUMBO_FRAME;
+
+	if (adapter->interface->max_desc_block_size > 1)
+		rx_offload_capa |= DEV_RX_OFFLOAD_SCATTER;
+	if (adapter->if_features & MQNIC_IF_FEATURE_RX_HASH)
+		rx_offload_capa |= DEV_RX_OFFLOAD_RSS_HASH;
+	if (adapter->if_features & MQNIC_IF_FEATURE_RX_CSUM)
+		rx_offload_capa |= DEV_RX_OFFLOAD_IPV4_CKSUM |
+				   DEV_RX_OFFLOAD_UDP_CKSUM |
+				   DEV_RX_OFFLOAD_TCP_CKSUM;
 
 	return rx_offload_capa;
 }
@@ -849,10 +1371,15 @@ eth_mqnic_rx_queue_setup(struct rte_eth_dev *dev,
 	const struct rte_memzone *rz;
 	struct mqnic_rx_queue *rxq;
 	uint64_t offloads;
+	uint32_t max_frame;
+	uint32_t nb_segs;
+	uint32_t cq_size;
+	size_t ring_bytes;
 	struct mqnic_adapter *adapter = MQNIC_DEV_PRIVATE(dev->data->dev_private);
 	struct mqnic_if *interface = adapter->interface;
 
 	offloads = rx_conf->offloads | dev->data->dev_conf.rxmode.offloads;
+	socket_id = mqnic_queue_socket(dev, "rx", queue_idx, socket_id);
 
 	/*
 	 * Validate number of receive descriptors.
@@ -874,17 +1401,44 @@ eth_mqnic_rx_queue_setup(struct rte_eth_dev *dev,
 	}
 
 	/* First allocate the RX queue data structure. */
-	rxq = rte_zmalloc("ethdev RX queue", sizeof(struct mqnic_rx_queue),
-			  RTE_CACHE_LINE_SIZE);
+	rxq = rte_zmalloc_socket("ethdev RX queue", sizeof(struct mqnic_rx_queue),
+				 RTE_CACHE_LINE_SIZE, socket_id);
 	if (rxq == NULL)
 		return -ENOMEM;
 
 	rxq->adapter = adapter;
 
+	/*
+	 * Frames larger than one mbuf are spread over a block of descriptors,
+	 * one mbuf each, which needs scatter to be enabled.
+	 */
+	if (rte_pktmbuf_data_room_size(mp) <= RTE_PKTMBUF_HEADROOM) {
+		PMD_INIT_LOG(ERR, "mbuf data room of pool %s is too small", mp->name);
+		mqnic_rx_queue_release(rxq);
+		return -EINVAL;
+	}
+	rxq->rx_buf_len = rte_pktmbuf_data_room_size(mp) - RTE_PKTMBUF_HEADROOM;
+	max_frame = mqnic_rx_max_frame_len(dev);
+	nb_segs = (max_frame + rxq->rx_buf_len - 1) / rxq->rx_buf_len;
+
+	if (nb_segs > 1 && !(offloads & DEV_RX_OFFLOAD_SCATTER)) {
+		PMD_INIT_LOG(ERR, "max frame (%u) exceeds mbuf data room (%u), "
+			     "DEV_RX_OFFLOAD_SCATTER is required",
+			     max_frame, rxq->rx_buf_len);
+		mqnic_rx_queue_release(rxq);
+		return -EINVAL;
+	}
+	if (nb_segs > interface->max_desc_block_size) {
+		PMD_INIT_LOG(ERR, "max frame (%u) needs %u mbufs, at most %u supported",
+			     max_frame, nb_segs, interface->max_desc_block_size);
+		mqnic_rx_queue_release(rxq);
+		return -EINVAL;
+	}
+
 	rxq->size = roundup_pow_of_two(nb_desc);
 	rxq->full_size = rxq->size >> 1;
 	rxq->size_mask = rxq->size-1;
-	rxq->stride = roundup_pow_of_two(MQNIC_DESC_SIZE);
+	rxq->stride = roundup_pow_of_two(MQNIC_DESC_SIZE * nb_segs);
 
 	rxq->desc_block_size = rxq->stride / MQNIC_DESC_SIZE;
 	rxq->log_desc_block_size = rxq->desc_block_size < 2 ? 0 : ilog2(rxq->desc_block_size-1)+1;
@@ -897,7 +1451,15 @@ eth_mqnic_rx_queue_setup(struct rte_eth_dev *dev,
 	rxq->nb_rx_desc = rxq->size;
 
 	rxq->drop_en = rx_conf->rx_drop_en;
-	rxq->rx_free_thresh = rx_conf->rx_free_thresh;
+	/* a 32-entry ring must still be usable with the default */
+	rxq->rx_free_thresh = rx_conf->rx_free_thresh ? rx_conf->rx_free_thresh :
+		RTE_MIN(MQNIC_DEFAULT_RX_FREE_THRESH, rxq->size / 2);
+	if (rxq->rx_free_thresh >= rxq->size) {
+		PMD_INIT_LOG(ERR, "rx_free_thresh(%u) must be less than %u.",
+			rxq->rx_free_thresh, rxq->size);
+		mqnic_rx_queue_release(rxq);
+		return -EINVAL;
+	}
 	rxq->queue_id = queue_idx;
 	rxq->reg_idx = queue_idx;
 	rxq->port_id = dev->data->port_id;
@@ -906,13 +1468,27 @@ eth_mqnic_rx_queue_setup(struct rte_eth_dev *dev,
 	else
 		rxq->crc_len = 0;
 
+	/* every posted descriptor block may complete before it is polled */
+	cq_size = adapter->rx_cq_size ? adapter->rx_cq_size :
+		mqnic_default_cq_size(adapter, rxq->size, rxq->size,
+				      dev->data->dev_conf.intr_conf.rxq ||
+				      adapter->event_poll);
+	if (cq_size < rxq->size) {
+		PMD_INIT_LOG(ERR, "rx_cq_size(%u) must be at least the ring size %u.",
+			     cq_size, rxq->size);
+		mqnic_rx_queue_release(rxq);
+		return -EINVAL;
+	}
+
 	/*
-	 *  Allocate RX ring hardware descriptors. A memzone large enough to
-	 *  handle the maximum ring size is allocated in order to allow for
-	 *  resizing in later calls to the queue setup function.
+	 * Allocate the ring memory of the queue, RX descriptors followed by
+	 * the completion ring. The memory of an earlier setup of this queue
+	 * is reused when it is large enough.
 	 */
-	rz = rte_eth_dma_zone_reserve(dev, "rx_ring", queue_idx, rxq->buf_size,
-				      MQNIC_ALIGN, socket_id);
+	ring_bytes = RTE_ALIGN_CEIL(rxq->buf_size, MQNIC_ALIGN);
+	rz = mqnic_ring_mem_reserve(dev, &adapter->rx_ring_mem[queue_idx],
+				    MQNIC_RING_MEM_RX, queue_idx,
+				    ring_bytes + mqnic_cpl_ring_bytes(cq_size), socket_id);
 	if (rz == NULL) {
 		mqnic_rx_queue_release(rxq);
 		return -ENOMEM;
@@ -933,10 +1509,21 @@ eth_mqnic_rx_queue_setup(struct rte_eth_dev *dev,
 	rxq->buf_dma_addr = rz->iova;
 	rxq->buf = (uint8_t *) rz->addr;
 
+	if (mqnic_cpl_queue_setup(dev, false, queue_idx, cq_size,
+				  (u8 *)rz->addr + ring_bytes, rz->iova + ring_bytes,
+				  socket_id)) {
+		PMD_INIT_LOG(ERR, "failed to size rx cpl queue %u", queue_idx);
+		mqnic_cpl_queue_free(dev, false, queue_idx);
+		mqnic_rx_queue_release(rxq);
+		return -ENOMEM;
+	}
+	rxq->cq_ring = adapter->rx_cpl_ring[queue_idx];
+
 	/* Allocate software ring. */
-	rxq->sw_ring = rte_zmalloc("rxq->sw_ring",
-				   sizeof(struct mqnic_rx_entry) * rxq->nb_rx_desc,
-				   RTE_CACHE_LINE_SIZE);
+	rxq->sw_ring = rte_zmalloc_socket("rxq->sw_ring",
+				   sizeof(struct mqnic_rx_entry) * rxq->nb_rx_desc *
+				   rxq->desc_block_size,
+				   RTE_CACHE_LINE_SIZE, socket_id);
 	if (rxq->sw_ring == NULL) {
 		PMD_INIT_LOG(ERR, "failed to alloc sw_ring");
 		mqnic_rx_queue_release(rxq);
@@ -947,6 +1534,7 @@ eth_mqnic_rx_queue_setup(struct rte_eth_dev *dev,
 
 	dev->data->rx_queues[queue_idx] = rxq;
 	mqnic_reset_rx_queue(rxq);
+	mqnic_rxq_vec_setup(rxq);
 
 	return 0;
 }
@@ -983,14 +1571,12 @@ mqnic_dev_free_queues(struct rte_eth_dev *dev)
 	for (i = 0; i < dev->data->nb_rx_queues; i++) {
 		eth_mqnic_rx_queue_release(dev->data->rx_queues[i]);
 		dev->data->rx_queues[i] = NULL;
-		rte_eth_dma_zone_free(dev, "rx_ring", i);
 	}
 	dev->data->nb_rx_queues = 0;
 
 	for (i = 0; i < dev->data->nb_tx_queues; i++) {
 		eth_mqnic_tx_queue_release(dev->data->tx_queues[i]);
 		dev->data->tx_queues[i] = NULL;
-		rte_eth_dma_zone_free(dev, "tx_ring", i);
 	}
 	dev->data->nb_tx_queues = 0;
 }
@@ -999,12 +1585,15 @@ void
 mqnic_dev_deactive_queues(struct rte_eth_dev *dev)
 {
 	uint16_t i;
+	/* a failed start may leave queues that were never set up */
 	for (i = 0; i < dev->data->nb_rx_queues; i++) {
-		mqnic_deactivate_rx_queue(dev->data->rx_queues[i]);
+		if (dev->data->rx_queues[i] != NULL)
+			mqnic_deactivate_rx_queue(dev->data->rx_queues[i]);
 	}
 
 	for (i = 0; i < dev->data->nb_tx_queues; i++) {
-		mqnic_deactivate_tx_queue(dev->data->tx_queues[i]);
+		if (dev->data->tx_queues[i] != NULL)
+			mqnic_deactivate_tx_queue(dev->data->tx_queues[i]);
 	}
 }
 
@@ -1017,33 +1606,17 @@ mqnic_dev_deactive_queues(struct rte_eth_dev *dev)
 static int
 mqnic_alloc_rx_queue_mbufs(struct mqnic_rx_queue *rxq)
 {
-	struct mqnic_rx_entry *rxe = rxq->sw_ring;
-	uint64_t dma_addr;
-	unsigned i;
-
-	/* Initialize software ring entries. */
-	for (i = 0; i < rxq->nb_rx_desc; i++) {
-		volatile struct mqnic_desc *rxd;
-		struct rte_mbuf *mbuf = rte_mbuf_raw_alloc(rxq->mb_pool);
-		if (mbuf == NULL) {
-			PMD_INIT_LOG(ERR, "RX mbuf alloc failed "
-				     "queue_id=%hu", rxq->queue_id);
-			return -ENOMEM;
-		}
+	/* Fill every ring slot, one descriptor block per slot. */
+	if (mqnic_rx_alloc_bulk(rxq, 0, rxq->size) != rxq->size) {
+		PMD_INIT_LOG(ERR, "RX mbuf alloc failed "
+			     "queue_id=%hu", rxq->queue_id);
+		return -ENOMEM;
+	}
 
-		dma_addr = rte_cpu_to_le_64(rte_mbuf_data_iova_default(mbuf));
-		rxd = &rxq->rx_ring[i];
-		rxd->len = mbuf->buf_len; //right????????
-		rxd->addr = dma_addr;
-		rxe[i].mbuf = mbuf;
+	rxq->head_ptr = rxq->size;
 
-		rxq->head_ptr++;
-
-		if((rxq->head_ptr == 1) || (rxq->head_ptr == rxq->nb_rx_desc)){
-			PMD_INIT_LOG(DEBUG, "rxd->len = mbuf->buf_len = %d, dma_addr=0x%lx, rxq->head_ptr=%d", 
-				mbuf->buf_len, dma_addr, rxq->head_ptr);
-		}
-	}
+	PMD_INIT_LOG(DEBUG, "queue_id=%hu posted %u blocks of %u x %u bytes",
+		     rxq->queue_id, rxq->size, rxq->desc_block_size, rxq->rx_buf_len);
 
 	return 0;
 }
@@ -1067,8 +1640,21 @@ eth_mqnic_rx_init(struct rte_eth_dev *dev)
 		}
 
 		rxq->flags = 0;
+		if ((rxq->adapter->if_features & MQNIC_IF_FEATURE_RX_HASH) &&
+		    (rxq->offloads & DEV_RX_OFFLOAD_RSS_HASH))
+			rxq->flags |= MQNIC_RXQ_FLAG_RX_HASH;
+		if ((rxq->adapter->if_features & MQNIC_IF_FEATURE_RX_CSUM) &&
+		    (rxq->offloads & DEV_RX_OFFLOAD_CHECKSUM))
+			rxq->flags |= MQNIC_RXQ_FLAG_RX_CSUM;
+		if (rxq->adapter->event_poll)
+			rxq->flags |= MQNIC_RXQ_FLAG_ARM_CQ;
 		rxq->hw = hw;
 
+		/* the refill may post every slot of the ring */
+		mqnic_cq_set_tail_batch(rxq->adapter, rxq->cq_ring, rxq->size,
+					dev->data->dev_conf.intr_conf.rxq ||
+					rxq->adapter->event_poll);
+
 		/* Allocate buffers for descriptor rings and set up queue */
 		ret = mqnic_alloc_rx_queue_mbufs(rxq);
 		if (ret)
@@ -1077,14 +1663,57 @@ eth_mqnic_rx_init(struct rte_eth_dev *dev)
 		mqnic_activate_rxq(rxq, i);
 	}
 
+	mqnic_set_rx_function(dev);
+
+	return 0;
+}
+
+/*
+ * The vector RX path only builds single-segment mbufs, so it is used only
+ * when no queue asks for an offload it cannot provide.
+ */
+static bool
+mqnic_rx_vec_allowed(struct rte_eth_dev *dev)
+{
+	struct mqnic_rx_queue *rxq;
+	uint16_t i;
+
+	for (i = 0; i < dev->data->nb_rx_queues; i++) {
+		rxq = dev->data->rx_queues[i];
+		if (rxq == NULL || (rxq->offloads & MQNIC_RX_NO_VECTOR_FLAGS))
+			return false;
+	}
+
+	return true;
+}
+
+void
+mqnic_set_rx_function(struct rte_eth_dev *dev)
+{
 	if (dev->data->dev_conf.rxmode.offloads & DEV_RX_OFFLOAD_SCATTER) {
 		if (!dev->data->scattered_rx)
 			PMD_INIT_LOG(DEBUG, "forcing scatter mode");
 		dev->rx_pkt_burst = eth_mqnic_recv_scattered_pkts;
 		dev->data->scattered_rx = 1;
+		return;
 	}
 
-	return 0;
+	dev->rx_pkt_burst = eth_mqnic_recv_pkts;
+
+#ifdef CC_AVX2_SUPPORT
+	if (mqnic_rx_vec_allowed(dev) &&
+	    rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_256 &&
+	    rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2) == 1) {
+		PMD_INIT_LOG(DEBUG, "Using AVX2 vector Rx (port %d).",
+			     dev->data->port_id);
+		dev->rx_pkt_burst = eth_mqnic_recv_pkts_vec_avx2;
+		return;
+	}
+#else
+	RTE_SET_USED(mqnic_rx_vec_allowed);
+#endif
+
+	PMD_INIT_LOG(DEBUG, "Using scalar Rx (port %d).", dev->data->port_id);
 }
 
 /*********************************************************************
@@ -1109,16 +1738,73 @@ int eth_mqnic_tx_init(struct rte_eth_dev *dev)
 			return -1;
 		}
 		txq->cpl_index = i;
+		txq->cq_ring = adapter->tx_cpl_ring[txq->cpl_index];
 		txq->hw = hw;
 		txq->adapter = adapter;
+		mqnic_cq_set_tail_batch(adapter, txq->cq_ring, txq->full_size,
+					adapter->event_poll);
 
 		PMD_TX_LOG(DEBUG, "Activating tx queue %d with completion queue %d", txq->queue_id, txq->cpl_index);
 		mqnic_activate_txq(txq);
 	}
 
+	mqnic_set_tx_function(dev);
+
 	return 0;
 }
 
+/*
+ * The vector TX paths only handle single-segment packets without
+ * offloads, so they are used only when no queue asks for more.
+ */
+static bool
+mqnic_tx_vec_allowed(struct rte_eth_dev *dev)
+{
+	struct mqnic_tx_queue *txq;
+	uint16_t i;
+
+	for (i = 0; i < dev->data->nb_tx_queues; i++) {
+		txq = dev->data->tx_queues[i];
+		if (txq == NULL || (txq->offloads & MQNIC_TX_NO_VECTOR_FLAGS))
+			return false;
+	}
+
+	return true;
+}
+
+void
+mqnic_set_tx_function(struct rte_eth_dev *dev)
+{
+	dev->tx_pkt_burst = eth_mqnic_xmit_pkts;
+
+	if (!mqnic_tx_vec_allowed(dev)) {
+		PMD_INIT_LOG(DEBUG, "Using scalar Tx (port %d).",
+			     dev->data->port_id);
+		return;
+	}
+
+#ifdef CC_AVX512_SUPPORT
+	if (rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_512 &&
+	    rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) == 1) {
+		PMD_INIT_LOG(DEBUG, "Using AVX512 vector Tx (port %d).",
+			     dev->data->port_id);
+		dev->tx_pkt_burst = eth_mqnic_xmit_pkts_vec_avx512;
+		return;
+	}
+#endif
+#ifdef CC_AVX2_SUPPORT
+	if (rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_256 &&
+	    rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2) == 1) {
+		PMD_INIT_LOG(DEBUG, "Using AVX2 vector Tx (port %d).",
+			     dev->data->port_id);
+		dev->tx_pkt_burst = eth_mqnic_xmit_pkts_vec_avx2;
+		return;
+	}
+#endif
+
+	PMD_INIT_LOG(DEBUG, "Using scalar Tx (port %d).", dev->data->port_id);
+}
+
 void
 mqnic_rxq_info_get(struct rte_eth_dev *dev, uint16_t queue_id,
 	struct rte_eth_rxq_info *qinfo)
@@ -1149,6 +1835,7 @@ mqnic_txq_info_get(struct rte_eth_dev *dev, uint16_t queue_id,
 	qinfo->conf.tx_thresh.pthresh = txq->pthresh;
 	qinfo->conf.tx_thresh.hthresh = txq->hthresh;
 	qinfo->conf.tx_thresh.wthresh = txq->wthresh;
+	qinfo->conf.tx_free_thresh = txq->tx_free_thresh;
 	qinfo->conf.offloads = txq->offloads;
 }
 
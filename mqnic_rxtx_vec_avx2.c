@@ -0,0 +1,204 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2023 Xinyu Yang.
+ */
+
+#include "mqnic_rxtx_vec_common.h"
+
+#include <rte_vect.h>
+
+/*
+ * Write the descriptor blocks of nb_pkts single-segment packets starting at
+ * ring slot index. The caller guarantees the blocks do not wrap.
+ */
+static __rte_always_inline void
+mqnic_tx_vec_blocks_avx2(struct mqnic_tx_queue *txq, uint32_t index,
+		struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	volatile struct mqnic_desc *txd =
+		(volatile struct mqnic_desc *)(txq->buf + index * txq->stride);
+	const uint32_t block = txq->desc_block_size;
+	const __m256i zero = _mm256_setzero_si256();
+	uint16_t i;
+	uint32_t j;
+
+	mqnic_tx_vec_backlog(txq, index, pkts, nb_pkts);
+
+	if (block == 1) {
+		/* one descriptor per block: two packets per 256-bit store */
+		for (i = 0; i + 1 < nb_pkts; i += 2, txd += 2)
+			_mm256_storeu_si256((__m256i *)(uintptr_t)txd,
+				_mm256_set_epi64x(mqnic_vec_desc_addr(pkts[i + 1]),
+						  mqnic_vec_desc_len(pkts[i + 1]),
+						  mqnic_vec_desc_addr(pkts[i]),
+						  mqnic_vec_desc_len(pkts[i])));
+		if (i < nb_pkts)
+			_mm_storeu_si128((__m128i *)(uintptr_t)txd,
+				_mm_set_epi64x(mqnic_vec_desc_addr(pkts[i]),
+					       mqnic_vec_desc_len(pkts[i])));
+		return;
+	}
+
+	/*
+	 * Blocks of two or more descriptors are 32-byte aligned: the first
+	 * store carries the descriptor and a zeroed second one, the rest of
+	 * the block is cleared 32 bytes at a time.
+	 */
+	for (i = 0; i < nb_pkts; i++, txd += block) {
+		_mm256_store_si256((__m256i *)(uintptr_t)txd,
+			_mm256_set_epi64x(0, 0,
+					  mqnic_vec_desc_addr(pkts[i]),
+					  mqnic_vec_desc_len(pkts[i])));
+		for (j = 2; j < block; j += 2)
+			_mm256_store_si256((__m256i *)(uintptr_t)&txd[j], zero);
+	}
+}
+
+uint16_t
+eth_mqnic_xmit_pkts_vec_avx2(void *tx_queue, struct rte_mbuf **tx_pkts,
+		uint16_t nb_pkts)
+{
+	struct mqnic_tx_queue *txq = tx_queue;
+	uint32_t index;
+	uint16_t n;
+
+	nb_pkts = mqnic_tx_vec_reserve(txq, nb_pkts);
+	if (unlikely(nb_pkts == 0))
+		return 0;
+
+	index = txq->head_ptr & txq->size_mask;
+	n = (uint16_t)RTE_MIN((uint32_t)nb_pkts, txq->size - index);
+
+	mqnic_tx_vec_blocks_avx2(txq, index, tx_pkts, n);
+	if (n < nb_pkts)
+		mqnic_tx_vec_blocks_avx2(txq, 0, tx_pkts + n, nb_pkts - n);
+
+	mqnic_tx_vec_doorbell(txq, nb_pkts);
+
+	return nb_pkts;
+}
+
+/* Completion records processed per iteration of the vector RX loop. */
+#define MQNIC_RX_VEC_BURST 4
+
+static __rte_always_inline __m256i
+mqnic_rx_vec_load_cpl(const struct mqnic_cq_ring *cq_ring, uint32_t ptr)
+{
+	return _mm256_loadu_si256((const __m256i *)(uintptr_t)
+			(cq_ring->buf + (ptr & cq_ring->size_mask) * cq_ring->stride));
+}
+
+/* Detach the mbuf of the ring slot named by a completion record. */
+static __rte_always_inline struct rte_mbuf *
+mqnic_rx_vec_take(struct mqnic_rx_queue *rxq, __m256i cpl)
+{
+	struct mqnic_rx_entry *rxe =
+		&rxq->sw_ring[_mm256_extract_epi16(cpl, 1) & rxq->size_mask];
+	struct rte_mbuf *mb = rxe->mbuf;
+
+	rxe->mbuf = NULL;
+	return mb;
+}
+
+/*
+ * Write the 32 bytes of an mbuf starting at rearm_data in one store: the
+ * precomputed rearm template, the queue's constant ol_flags and
+ * rx_descriptor_fields1 with cpl->len shuffled into pkt_len and data_len
+ * and, when enabled, cpl->rx_hash into hash.rss.
+ */
+static __rte_always_inline void
+mqnic_rx_vec_fill(struct rte_mbuf *mb, __m256i cpl,
+		const __m256i rearm, const __m256i shuf)
+{
+	/* bring the first and third quadwords of the record to the upper lane */
+	__m256i fields = _mm256_permute4x64_epi64(cpl, 0x80);
+
+	fields = _mm256_shuffle_epi8(fields, shuf);
+	_mm256_storeu_si256((__m256i *)(uintptr_t)&mb->rearm_data,
+			    _mm256_or_si256(fields, rearm));
+}
+
+uint16_t
+eth_mqnic_recv_pkts_vec_avx2(void *rx_queue, struct rte_mbuf **rx_pkts,
+		uint16_t nb_pkts)
+{
+	struct mqnic_rx_queue *rxq = rx_queue;
+	struct mqnic_cq_ring *cq_ring = rxq->adapter->rx_cpl_ring[rxq->cpl_index];
+	const bool rx_hash = rxq->flags & MQNIC_RXQ_FLAG_RX_HASH;
+	const __m256i rearm = _mm256_set_epi64x(0, 0,
+			rx_hash ? PKT_RX_RSS_HASH : 0, rxq->mbuf_initializer);
+	const __m256i shuf = _mm256_set_epi8(
+			/* hash.rss = cpl->rx_hash, if delivered */
+			rx_hash ? 11 : -1, rx_hash ? 10 : -1,
+			rx_hash ? 9 : -1, rx_hash ? 8 : -1,
+			/* vlan_tci */
+			-1, -1,
+			/* data_len = cpl->len */
+			5, 4,
+			/* pkt_len = cpl->len */
+			-1, -1, 5, 4,
+			/* packet_type */
+			-1, -1, -1, -1,
+			/* rearm_data and ol_flags come from the template */
+			-1, -1, -1, -1, -1, -1, -1, -1,
+			-1, -1, -1, -1, -1, -1, -1, -1);
+	uint32_t cq_tail_ptr;
+	uint64_t bytes = 0;
+	uint16_t nb_rx, i;
+
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, ol_flags) !=
+			 offsetof(struct rte_mbuf, rearm_data) + 8);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, rx_descriptor_fields1) !=
+			 offsetof(struct rte_mbuf, rearm_data) + 16);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, pkt_len) !=
+			 offsetof(struct rte_mbuf, rx_descriptor_fields1) + 4);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, data_len) !=
+			 offsetof(struct rte_mbuf, rx_descriptor_fields1) + 8);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, hash) !=
+			 offsetof(struct rte_mbuf, rx_descriptor_fields1) + 12);
+	RTE_BUILD_BUG_ON(offsetof(struct mqnic_cpl, index) != 2);
+	RTE_BUILD_BUG_ON(offsetof(struct mqnic_cpl, len) != 4);
+	RTE_BUILD_BUG_ON(offsetof(struct mqnic_cpl, rx_hash) != 16);
+
+	nb_pkts = (uint16_t)RTE_MIN((uint32_t)nb_pkts, rxq->full_size);
+	mqnic_rx_cq_poll_head_ptr(cq_ring, nb_pkts);
+	cq_tail_ptr = cq_ring->tail_ptr;
+
+	nb_pkts = (uint16_t)RTE_MIN((uint32_t)nb_pkts, cq_ring->head_ptr - cq_tail_ptr);
+
+	for (nb_rx = 0; nb_rx + MQNIC_RX_VEC_BURST <= nb_pkts;
+	     nb_rx += MQNIC_RX_VEC_BURST) {
+		__m256i cpl[MQNIC_RX_VEC_BURST];
+		struct rte_mbuf *mb[MQNIC_RX_VEC_BURST];
+
+		for (i = 0; i < MQNIC_RX_VEC_BURST; i++) {
+			cpl[i] = mqnic_rx_vec_load_cpl(cq_ring, cq_tail_ptr + nb_rx + i);
+			mb[i] = mqnic_rx_vec_take(rxq, cpl[i]);
+			rte_mqnic_prefetch(mb[i]);
+		}
+
+		for (i = 0; i < MQNIC_RX_VEC_BURST; i++) {
+			mqnic_rx_vec_fill(mb[i], cpl[i], rearm, shuf);
+			bytes += (uint16_t)_mm256_extract_epi16(cpl[i], 2);
+			rx_pkts[nb_rx + i] = mb[i];
+		}
+	}
+
+	for (; nb_rx < nb_pkts; nb_rx++) {
+		__m256i cpl = mqnic_rx_vec_load_cpl(cq_ring, cq_tail_ptr + nb_rx);
+		struct rte_mbuf *mb = mqnic_rx_vec_take(rxq, cpl);
+
+		mqnic_rx_vec_fill(mb, cpl, rearm, shuf);
+		bytes += (uint16_t)_mm256_extract_epi16(cpl, 2);
+		rx_pkts[nb_rx] = mb;
+	}
+
+	rxq->stats.packets += nb_rx;
+	rxq->stats.bytes += bytes;
+
+	// update CQ tail
+	cq_ring->tail_ptr = cq_tail_ptr + nb_rx;
+	mqnic_rx_complete(rxq, cq_ring);
+
+	return nb_rx;
+}
@@ -0,0 +1,98 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2023 Xinyu Yang.
+ */
+
+#include "mqnic_rxtx_vec_common.h"
+
+#include <rte_vect.h>
+
+/*
+ * Write the descriptor blocks of nb_pkts single-segment packets starting at
+ * ring slot index, one 512-bit store per 64 bytes of ring. The caller
+ * guarantees the blocks do not wrap.
+ */
+static __rte_always_inline void
+mqnic_tx_vec_blocks_avx512(struct mqnic_tx_queue *txq, uint32_t index,
+		struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	volatile struct mqnic_desc *txd =
+		(volatile struct mqnic_desc *)(txq->buf + index * txq->stride);
+	uint16_t i = 0;
+
+	mqnic_tx_vec_backlog(txq, index, pkts, nb_pkts);
+
+	switch (txq->desc_block_size) {
+	case 1:
+		/* four packets per store */
+		for (; i + 3 < nb_pkts; i += 4, txd += 4)
+			_mm512_storeu_si512((void *)(uintptr_t)txd,
+				_mm512_set_epi64(mqnic_vec_desc_addr(pkts[i + 3]),
+						 mqnic_vec_desc_len(pkts[i + 3]),
+						 mqnic_vec_desc_addr(pkts[i + 2]),
+						 mqnic_vec_desc_len(pkts[i + 2]),
+						 mqnic_vec_desc_addr(pkts[i + 1]),
+						 mqnic_vec_desc_len(pkts[i + 1]),
+						 mqnic_vec_desc_addr(pkts[i]),
+						 mqnic_vec_desc_len(pkts[i])));
+		for (; i < nb_pkts; i++, txd++)
+			_mm_storeu_si128((__m128i *)(uintptr_t)txd,
+				_mm_set_epi64x(mqnic_vec_desc_addr(pkts[i]),
+					       mqnic_vec_desc_len(pkts[i])));
+		break;
+	case 2:
+		/* two packets per store, each followed by a zeroed descriptor */
+		for (; i + 1 < nb_pkts; i += 2, txd += 4)
+			_mm512_storeu_si512((void *)(uintptr_t)txd,
+				_mm512_set_epi64(0, 0,
+						 mqnic_vec_desc_addr(pkts[i + 1]),
+						 mqnic_vec_desc_len(pkts[i + 1]),
+						 0, 0,
+						 mqnic_vec_desc_addr(pkts[i]),
+						 mqnic_vec_desc_len(pkts[i])));
+		if (i < nb_pkts)
+			_mm256_store_si256((__m256i *)(uintptr_t)txd,
+				_mm256_set_epi64x(0, 0,
+						  mqnic_vec_desc_addr(pkts[i]),
+						  mqnic_vec_desc_len(pkts[i])));
+		break;
+	default:
+		/* a whole 64-byte block per store, cleared beyond 64 bytes */
+		for (; i < nb_pkts; i++, txd += txq->desc_block_size) {
+			uint32_t j;
+
+			_mm512_store_si512((void *)(uintptr_t)txd,
+				_mm512_set_epi64(0, 0, 0, 0, 0, 0,
+						 mqnic_vec_desc_addr(pkts[i]),
+						 mqnic_vec_desc_len(pkts[i])));
+			for (j = 4; j < txq->desc_block_size; j += 4)
+				_mm512_store_si512((void *)(uintptr_t)&txd[j],
+						   _mm512_setzero_si512());
+		}
+		break;
+	}
+}
+
+uint16_t
+eth_mqnic_xmit_pkts_vec_avx512(void *tx_queue, struct rte_mbuf **tx_pkts,
+		uint16_t nb_pkts)
+{
+	struct mqnic_tx_queue *txq = tx_queue;
+	uint32_t index;
+	uint16_t n;
+
+	nb_pkts = mqnic_tx_vec_reserve(txq, nb_pkts);
+	if (unlikely(nb_pkts == 0))
+		return 0;
+
+	index = txq->head_ptr & txq->size_mask;
+	n = (uint16_t)RTE_MIN((uint32_t)nb_pkts, txq->size - index);
+
+	mqnic_tx_vec_blocks_avx512(txq, index, tx_pkts, n);
+	if (n < nb_pkts)
+		mqnic_tx_vec_blocks_avx512(txq, 0, tx_pkts + n, nb_pkts - n);
+
+	mqnic_tx_vec_doorbell(txq, nb_pkts);
+
+	return nb_pkts;
+}
@@ -0,0 +1,70 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2023 Xinyu Yang.
+ */
+
+#ifndef _MQNIC_RXTX_VEC_COMMON_H_
+#define _MQNIC_RXTX_VEC_COMMON_H_
+
+#include "mqnic.h"
+
+/*
+ * First and second quadword of a single-segment TX descriptor.
+ * struct mqnic_desc keeps rsvd0 and tx_csum_cmd in the low 32 bits of the
+ * first quadword and the length in the high 32 bits; the buffer address is
+ * the second quadword.
+ */
+static __rte_always_inline long long
+mqnic_vec_desc_len(const struct rte_mbuf *m)
+{
+	return (long long)((uint64_t)m->data_len << 32);
+}
+
+static __rte_always_inline long long
+mqnic_vec_desc_addr(const struct rte_mbuf *m)
+{
+	return (long long)rte_mbuf_data_iova(m);
+}
+
+/*
+ * Number of packets of a vector TX burst that fit in the ring.
+ * Completions are reclaimed first when the ring is running low, exactly
+ * as in the scalar path.
+ */
+static __rte_always_inline uint16_t
+mqnic_tx_vec_reserve(struct mqnic_tx_queue *txq, uint16_t nb_pkts)
+{
+	if (mqnic_tx_free_slots(txq) < txq->tx_free_thresh)
+		mqnic_tx_reclaim(txq);
+
+	return (uint16_t)RTE_MIN((uint32_t)nb_pkts, mqnic_tx_free_slots(txq));
+}
+
+/* Record the mbufs of a burst in the software ring and account for them. */
+static __rte_always_inline void
+mqnic_tx_vec_backlog(struct mqnic_tx_queue *txq, uint32_t index,
+		struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
+{
+	struct mqnic_tx_entry *txe = &txq->sw_ring[index];
+	uint64_t bytes = 0;
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++) {
+		txe[i].mbuf[0] = tx_pkts[i];
+		bytes += tx_pkts[i]->data_len;
+	}
+
+	txq->stats.packets += nb_pkts;
+	txq->stats.bytes += bytes;
+}
+
+/* Publish a burst to the NIC with a single head pointer write. */
+static __rte_always_inline void
+mqnic_tx_vec_doorbell(struct mqnic_tx_queue *txq, uint16_t nb_pkts)
+{
+	txq->head_ptr += nb_pkts;
+	rte_wmb();
+	MQNIC_DIRECT_WRITE_REG(txq->hw_head_ptr, 0, txq->head_ptr & txq->hw_ptr_mask);
+}
+
+#endif /* _MQNIC_RXTX_VEC_COMMON_H_ */
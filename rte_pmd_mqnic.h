@@ -0,0 +1,99 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2023 Xinyu Yang.
+ */
+
+#ifndef _RTE_PMD_MQNIC_H_
+#define _RTE_PMD_MQNIC_H_
+
+/**
+ * @file rte_pmd_mqnic.h
+ *
+ * mqnic PMD specific functions.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change, or be removed, without prior notice
+ *
+ */
+
+#include <stdint.h>
+
+#include <rte_compat.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A queue with completions pending, as reported by
+ * rte_pmd_mqnic_poll_events().
+ */
+struct rte_pmd_mqnic_event {
+	uint16_t queue_id; /**< RX or TX queue index. */
+	uint8_t is_tx;     /**< Non-zero for a TX queue. */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change, or be removed, without prior notice
+ *
+ * Get the event queue that reports completions of a queue. RX and TX
+ * queue i share event queue i modulo the number of event queues, so an
+ * lcore serving both directions of a set of queue indexes polls the
+ * event queues of those indexes.
+ *
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @param queue_id
+ *   The RX or TX queue index.
+ * @param is_tx
+ *   Non-zero for a TX queue.
+ * @return
+ *   - (>=0) the event queue index.
+ *   - (-ENODEV) if *port_id* is invalid.
+ *   - (-ENOTSUP) if *port_id* is not an mqnic port.
+ *   - (-EINVAL) if the queue has not been set up.
+ */
+__rte_experimental
+int
+rte_pmd_mqnic_get_event_queue(uint16_t port_id, uint16_t queue_id,
+			      uint8_t is_tx);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change, or be removed, without prior notice
+ *
+ * Drain an event queue and report the queues that posted completions
+ * since they were last polled, at the cost of one MMIO read for all the
+ * queues mapped to the event queue. A queue is reported once until its
+ * burst function, or rte_eth_tx_done_cleanup() for TX, has consumed its
+ * completions. Requires the event_poll=1 devarg, which keeps the
+ * completion queues armed, and is incompatible with RX interrupts.
+ *
+ * The event queue must only be polled by one thread at a time.
+ *
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @param eq_id
+ *   The event queue index, see rte_pmd_mqnic_get_event_queue().
+ * @param events
+ *   Array receiving the queues with pending completions.
+ * @param nb_events
+ *   Size of *events*; events beyond it stay queued for the next call.
+ * @return
+ *   - (>=0) the number of entries written to *events*.
+ *   - (-ENODEV) if *port_id* is invalid.
+ *   - (-ENOTSUP) if *port_id* is not an mqnic port or event_poll is off.
+ *   - (-EINVAL) if *eq_id* is out of range.
+ */
+__rte_experimental
+int
+rte_pmd_mqnic_poll_events(uint16_t port_id, uint16_t eq_id,
+			  struct rte_pmd_mqnic_event *events,
+			  uint16_t nb_events);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_PMD_MQNIC_H_ */